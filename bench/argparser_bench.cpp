@@ -0,0 +1,251 @@
+#include <benchmark/benchmark.h>
+#include <lib/ArgParser.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ArgumentParser;
+
+namespace {
+    // fixed seed, so every run parses the same command lines
+    constexpr uint32_t kSeed = 20240917;
+
+    enum TokenMix {
+        kLong,      // --optN 5
+        kEquals,    // --optN=5
+        kShort,     // -A 5
+        kClustered, // -abcdefgh
+    };
+
+    const char* MixName(int64_t mix) {
+        static const char* const kNames[] = {"long", "equals", "short", "clustered"};
+        return kNames[mix];
+    }
+
+    // 26 short flags a..z plus option_count optional int options; the first 26
+    // of those also get short names A..Z.
+    std::unique_ptr<ArgParser> MakeParser(int64_t option_count) {
+        auto parser = std::make_unique<ArgParser>("Bench");
+        for (char ch = 'a'; ch <= 'z'; ++ch) {
+            parser->AddFlag(ch, std::string("flag_") + ch);
+        }
+        for (int64_t i = 0; i < option_count; ++i) {
+            std::string name = "opt" + std::to_string(i);
+            if (i < 26) {
+                parser->AddIntArgument(static_cast<char>('A' + i), name).Default(0);
+            } else {
+                parser->AddIntArgument(name).Default(0);
+            }
+        }
+        parser->AddStringArgument("input").Default("");
+        parser->AddIntArgument("values").MultiValue().Positional().Default(0);
+        parser->AddHelp('h', "help", "Benchmark schema");
+        return parser;
+    }
+
+    std::vector<std::string> MakeArgs(int64_t option_count, int64_t token_count, TokenMix mix) {
+        std::mt19937 random(kSeed);
+        std::uniform_int_distribution<int64_t> option(0, option_count - 1);
+        std::uniform_int_distribution<int64_t> short_option(0, std::min<int64_t>(option_count, 26) - 1);
+        // non-negative: a separate "-5" would be read as an option
+        std::uniform_int_distribution<int> value(0, 1000000);
+        std::vector<std::string> args = {"bench"};
+        while (static_cast<int64_t>(args.size()) <= token_count) {
+            switch (mix) {
+                case kLong:
+                    args.push_back("--opt" + std::to_string(option(random)));
+                    args.push_back(std::to_string(value(random)));
+                    break;
+                case kEquals:
+                    args.push_back("--opt" + std::to_string(option(random)) + "=" + std::to_string(value(random)));
+                    break;
+                case kShort:
+                    args.push_back(std::string("-") + static_cast<char>('A' + short_option(random)));
+                    args.push_back(std::to_string(value(random)));
+                    break;
+                case kClustered:
+                    args.push_back("-abcdefgh");
+                    break;
+            }
+        }
+        return args;
+    }
+
+    std::vector<char*> MakeArgv(std::vector<std::string>& args) {
+        std::vector<char*> argv;
+        for (std::string& arg : args) {
+            argv.push_back(arg.data());
+        }
+        return argv;
+    }
+
+    // Args: options registered, tokens per command line, TokenMix.
+    void MixArguments(benchmark::internal::Benchmark* bench) {
+        for (int64_t options : {10, 1000, 100000}) {
+            for (int64_t mix = kLong; mix <= kClustered; ++mix) {
+                bench->Args({options, 64, mix});
+            }
+        }
+        for (int64_t tokens : {8, 512, 32768}) {
+            bench->Args({1000, tokens, kEquals});
+        }
+    }
+
+    void BM_ParseVector(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        std::vector<std::string> args = MakeArgs(state.range(0), state.range(1), static_cast<TokenMix>(state.range(2)));
+        for (auto _ : state) {
+            if (!parser->Parse(args)) {
+                state.SkipWithError("parse failed");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(args.size() - 1));
+        state.SetLabel(MixName(state.range(2)));
+    }
+    BENCHMARK(BM_ParseVector)->Apply(MixArguments)->ArgNames({"options", "tokens", "mix"});
+
+    void BM_ParseArgv(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        std::vector<std::string> args = MakeArgs(state.range(0), state.range(1), static_cast<TokenMix>(state.range(2)));
+        std::vector<char*> argv = MakeArgv(args);
+        for (auto _ : state) {
+            if (!parser->Parse(static_cast<int>(argv.size()), argv.data())) {
+                state.SkipWithError("parse failed");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(args.size() - 1));
+        state.SetLabel(MixName(state.range(2)));
+    }
+    BENCHMARK(BM_ParseArgv)->Apply(MixArguments)->ArgNames({"options", "tokens", "mix"});
+
+    void BM_ParseFrozen(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        parser->Freeze();
+        std::vector<std::string> args = MakeArgs(state.range(0), 64, kEquals);
+        for (auto _ : state) {
+            if (!parser->Parse(args)) {
+                state.SkipWithError("parse failed");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(args.size() - 1));
+    }
+    BENCHMARK(BM_ParseFrozen)->Arg(10)->Arg(1000)->Arg(100000)->ArgName("options");
+
+    // Args: positional values, pre-scan on/off, parallel conversion threads
+    // (0: off).
+    void BM_ParsePositional(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(10);
+        parser->PreScan(state.range(1) != 0);
+        if (state.range(2) != 0) {
+            parser->ParallelConversion(static_cast<size_t>(state.range(2)));
+        }
+        std::vector<std::string> args = {"bench"};
+        std::mt19937 random(kSeed);
+        std::uniform_int_distribution<int> value(0, 1000000000);
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            args.push_back(std::to_string(value(random)));
+        }
+        for (auto _ : state) {
+            if (!parser->Parse(args)) {
+                state.SkipWithError("parse failed");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ParsePositional)
+        ->ArgsProduct({{100, 10000, 1000000}, {0, 1}, {0}})
+        ->ArgsProduct({{1000000}, {1}, {1, 4, 16}})
+        ->ArgNames({"values", "prescan", "threads"});
+
+    void BM_ParseDoubles(benchmark::State& state) {
+        ArgParser parser("Bench");
+        parser.AddDoubleArgument("weights").MultiValue().Positional();
+        parser.PreScan();
+        std::vector<std::string> args = {"bench"};
+        std::mt19937 random(kSeed);
+        // non-negative, like MakeArgs
+        std::uniform_real_distribution<double> value(0.0, 1000.0);
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            args.push_back(std::to_string(value(random)));
+        }
+        for (auto _ : state) {
+            if (!parser.Parse(args)) {
+                state.SkipWithError("parse failed");
+                break;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ParseDoubles)->Arg(100)->Arg(10000)->Arg(1000000)->ArgName("values");
+
+    void BM_GetIntValue(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        if (!parser->Parse(MakeArgs(state.range(0), 64, kEquals))) {
+            state.SkipWithError("parse failed");
+            return;
+        }
+        std::vector<std::string> names;
+        for (int64_t i = 0; i < 64; ++i) {
+            names.push_back("opt" + std::to_string(i % state.range(0)));
+        }
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(parser->GetIntValue(names[next]));
+            next = (next + 1) % names.size();
+        }
+    }
+    BENCHMARK(BM_GetIntValue)->Arg(10)->Arg(1000)->Arg(100000)->ArgName("options");
+
+    void BM_GetIntHandle(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        if (!parser->Parse(MakeArgs(state.range(0), 64, kEquals))) {
+            state.SkipWithError("parse failed");
+            return;
+        }
+        std::vector<Option<int>> handles;
+        for (int64_t i = 0; i < 64; ++i) {
+            handles.emplace_back(parser->GetSchema().FindIndex("opt" + std::to_string(i % state.range(0))));
+        }
+        size_t next = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(parser->Get(handles[next]));
+            next = (next + 1) % handles.size();
+        }
+    }
+    BENCHMARK(BM_GetIntHandle)->Arg(10)->Arg(1000)->Arg(100000)->ArgName("options");
+
+    void BM_GetStringValue(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        if (!parser->Parse({"bench", "--input=some/path/to/an/input/file.txt"})) {
+            state.SkipWithError("parse failed");
+            return;
+        }
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(parser->GetStringValue("input"));
+        }
+    }
+    BENCHMARK(BM_GetStringValue)->Arg(10)->Arg(100000)->ArgName("options");
+
+    void BM_HelpDescription(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(parser->HelpDescription());
+        }
+    }
+    BENCHMARK(BM_HelpDescription)->Arg(10)->Arg(1000)->ArgName("options");
+
+    void BM_HelpDescriptionFrozen(benchmark::State& state) {
+        std::unique_ptr<ArgParser> parser = MakeParser(state.range(0));
+        parser->Freeze();
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(parser->HelpDescription());
+        }
+    }
+    BENCHMARK(BM_HelpDescriptionFrozen)->Arg(10)->Arg(1000)->ArgName("options");
+} // namespace
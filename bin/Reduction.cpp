@@ -0,0 +1,126 @@
+#include "Reduction.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define LABWORK_HAVE_AVX2_DISPATCH 1
+#endif
+
+namespace {
+    // small enough that no chunk sum can leave the int64_t range
+    constexpr size_t kChunkSize = size_t{1} << 16;
+
+    int64_t SumScalar(const int* data, size_t size) {
+        // independent accumulators so the loop is not one long dependency chain
+        int64_t acc[4] = {0, 0, 0, 0};
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4) {
+            acc[0] += data[i];
+            acc[1] += data[i + 1];
+            acc[2] += data[i + 2];
+            acc[3] += data[i + 3];
+        }
+        for (; i < size; ++i) {
+            acc[0] += data[i];
+        }
+        return acc[0] + acc[1] + acc[2] + acc[3];
+    }
+
+#ifdef LABWORK_HAVE_AVX2_DISPATCH
+    // Sign-extends eight ints at a time into two vectors of four int64 lanes.
+    __attribute__((target("avx2"))) int64_t SumAvx2(const int* data, size_t size) {
+        __m256i low = _mm256_setzero_si256();
+        __m256i high = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            low = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(chunk)));
+            high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(chunk, 1)));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(low, high));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumScalar(data + i, size - i);
+    }
+#endif
+
+    using SumKernel = int64_t (*)(const int*, size_t);
+
+    SumKernel SelectSumKernel() {
+#ifdef LABWORK_HAVE_AVX2_DISPATCH
+        if (__builtin_cpu_supports("avx2")) {
+            return SumAvx2;
+        }
+#endif
+        return SumScalar;
+    }
+
+    size_t ChunkCount(size_t size) {
+        return (size + kChunkSize - 1) / kChunkSize;
+    }
+} // namespace
+
+__int128 ParallelSum(std::span<const int> values, ArgumentParser::ThreadPool& pool) {
+    static const SumKernel kernel = SelectSumKernel();
+    std::vector<int64_t> partial(ChunkCount(values.size()));
+    pool.ParallelFor(partial.size(), [&](size_t chunk, size_t) {
+        std::span<const int> part = values.subspan(chunk * kChunkSize,
+                                                   std::min(kChunkSize, values.size() - chunk * kChunkSize));
+        partial[chunk] = kernel(part.data(), part.size());
+    });
+    __int128 total = 0;
+    for (int64_t sum : partial) {
+        total += sum;
+    }
+    return total;
+}
+
+bool ParallelProduct(std::span<const int> values, ArgumentParser::ThreadPool& pool, int64_t& product) {
+    struct Partial {
+        int64_t product = 1;
+        bool has_zero = false;
+        bool is_overflow = false;
+    };
+    std::vector<Partial> partial(ChunkCount(values.size()));
+    pool.ParallelFor(partial.size(), [&](size_t chunk, size_t) {
+        Partial& result = partial[chunk];
+        size_t end = std::min(values.size(), (chunk + 1) * kChunkSize);
+        for (size_t i = chunk * kChunkSize; i < end; ++i) {
+            if (values[i] == 0) {
+                result.has_zero = true;
+                return;
+            }
+            result.is_overflow |= __builtin_mul_overflow(result.product, values[i], &result.product);
+        }
+    });
+    // a zero anywhere wins over an overflow elsewhere
+    int64_t total = 1;
+    bool is_overflow = false;
+    for (const Partial& result : partial) {
+        if (result.has_zero) {
+            product = 0;
+            return true;
+        }
+        is_overflow |= result.is_overflow || __builtin_mul_overflow(total, result.product, &total);
+    }
+    if (is_overflow) {
+        return false;
+    }
+    product = total;
+    return true;
+}
+
+std::string ToString(__int128 value) {
+    bool is_negative = value < 0;
+    unsigned __int128 magnitude = is_negative ? -static_cast<unsigned __int128>(value) : value;
+    std::string digits;
+    do {
+        digits.push_back(static_cast<char>('0' + magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (is_negative) {
+        digits.push_back('-');
+    }
+    return std::string(digits.rbegin(), digits.rend());
+}
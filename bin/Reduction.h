@@ -0,0 +1,16 @@
+#pragma once
+
+#include <lib/ThreadPool.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Exact sum of values. Every chunk is added up with SIMD into 64-bit lanes,
+// which a chunk cannot overflow, and the chunk sums are combined in 128 bits.
+__int128 ParallelSum(std::span<const int> values, ArgumentParser::ThreadPool& pool);
+
+// Product of values; returns false if it does not fit into int64_t.
+bool ParallelProduct(std::span<const int> values, ArgumentParser::ThreadPool& pool, int64_t& product);
+
+std::string ToString(__int128 value);
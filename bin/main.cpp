@@ -1,8 +1,8 @@
-#include <functional>
+#include "Reduction.h"
 #include <lib/ArgParser.h>
 
+#include <chrono>
 #include <iostream>
-#include <numeric>
 
 struct Options {
     bool sum = false;
@@ -15,30 +15,40 @@ int main(int argc, char** argv) {
 
     ArgumentParser::ArgParser parser("Program");
     parser.AddIntArgument("N").MultiValue(1).Positional().StoreValues(values);
-    parser.AddFlag("sum", "add args").StoreValue(opt.sum);
-    parser.AddFlag("mult", "multiply args").StoreValue(opt.mult);
+    parser.AddFlag("sum", "add args").Default(false).StoreValue(opt.sum);
+    parser.AddFlag("mult", "multiply args").Default(false).StoreValue(opt.mult);
     parser.AddHelp('h', "help", "Program accumulate arguments");
+    parser.ResponseFiles();
 
     if(!parser.Parse(argc, argv)) {
         std::cout << "Wrong argument" << std::endl;
-        std::cout << parser.HelpDescription() << std::endl;
+        parser.WriteHelp(std::cout);
         return 1;
     }
 
     if(parser.Help()) {
-        std::cout << parser.HelpDescription() << std::endl;
+        parser.WriteHelp(std::cout);
         return 0;
     }
 
+    ArgumentParser::ThreadPool pool;
+    auto start = std::chrono::steady_clock::now();
     if(opt.sum) {
-        std::cout << "Result: " << std::accumulate(values.begin(), values.end(), 0) << std::endl;
+        std::cout << "Result: " << ToString(ParallelSum(values, pool)) << std::endl;
     } else if(opt.mult) {
-        std::cout << "Result: " << std::accumulate(values.begin(), values.end(), 1, std::multiplies<int>()) << std::endl;
+        int64_t product;
+        if(ParallelProduct(values, pool, product)) {
+            std::cout << "Result: " << product << std::endl;
+        } else {
+            std::cout << "Result: overflow, the product does not fit into 64 bits" << std::endl;
+        }
     } else {
         std::cout << "No one options had chosen" << std::endl;
-        std::cout << parser.HelpDescription();
+        parser.WriteHelp(std::cout);
         return 1;
     }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Time: " << elapsed.count() << " ms (" << pool.Size() << " threads)" << std::endl;
 
     return 0;
 
@@ -0,0 +1,58 @@
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <atomic>
+
+namespace ArgumentParser {
+    namespace {
+        // constant-initialized, so they are usable from operator new at any time
+        struct ThreadCounters {
+            uint64_t allocations;
+            uint64_t bytes;
+            int64_t live_bytes;
+            int64_t peak_bytes;
+        };
+
+        thread_local ThreadCounters counters = {0, 0, 0, 0};
+        std::atomic<bool> is_enabled = false;
+    } // namespace
+
+    namespace detail {
+        void EnableAllocationCounting() {
+            is_enabled.store(true, std::memory_order_relaxed);
+        }
+
+        void RecordAllocation(size_t size) {
+            ++counters.allocations;
+            counters.bytes += size;
+            counters.live_bytes += static_cast<int64_t>(size);
+            counters.peak_bytes = std::max(counters.peak_bytes, counters.live_bytes);
+        }
+
+        void RecordDeallocation(size_t size) {
+            counters.live_bytes -= static_cast<int64_t>(size);
+        }
+    } // namespace detail
+
+    AllocationScope::AllocationScope()
+        : allocations_(counters.allocations), bytes_(counters.bytes),
+          live_bytes_(counters.live_bytes), outer_peak_(counters.peak_bytes) {
+        counters.peak_bytes = counters.live_bytes;
+    }
+
+    AllocationScope::~AllocationScope() {
+        counters.peak_bytes = std::max(counters.peak_bytes, outer_peak_);
+    }
+
+    AllocationStats AllocationScope::Stats() const {
+        return AllocationStats{
+            static_cast<size_t>(counters.allocations - allocations_),
+            static_cast<size_t>(counters.bytes - bytes_),
+            static_cast<size_t>(counters.peak_bytes - live_bytes_),
+        };
+    }
+
+    bool AllocationScope::IsEnabled() {
+        return is_enabled.load(std::memory_order_relaxed);
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ArgumentParser {
+
+    struct AllocationStats {
+        size_t allocations = 0;
+        size_t bytes = 0;
+        size_t peak_bytes = 0; // most bytes live at once, counted from the scope start
+    };
+
+    // Counts the global operator new calls of the current thread while alive:
+    //
+    //     AllocationScope scope;
+    //     schema.Parse(args, result);
+    //     AllocationStats stats = scope.Stats();
+    //
+    // Counting needs the replacement operator new/delete of the
+    // argparser_alloc_counter object library to be linked into the program;
+    // without it IsEnabled() is false and all numbers stay zero.
+    class AllocationScope {
+    public:
+        AllocationScope();
+        ~AllocationScope();
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+        AllocationStats Stats() const;
+        static bool IsEnabled();
+
+    private:
+        uint64_t allocations_;
+        uint64_t bytes_;
+        int64_t live_bytes_;
+        int64_t outer_peak_;
+    };
+
+    namespace detail {
+        // Hooks for the replacement operator new/delete.
+        void EnableAllocationCounting();
+        void RecordAllocation(size_t size);
+        void RecordDeallocation(size_t size);
+    } // namespace detail
+
+} // namespace ArgumentParser
@@ -0,0 +1,54 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace ArgumentParser {
+    Arena::Arena(size_t initial_size) {
+        AddBlock(std::max<size_t>(initial_size, 64));
+    }
+
+    void Arena::AddBlock(size_t size) {
+        blocks_.push_back(Block{std::make_unique<std::byte[]>(size), size});
+        used_ = 0;
+    }
+
+    void Arena::Reset() {
+        if (blocks_.size() > 1) {
+            // merge into one block big enough for the whole previous parse
+            size_t total = Capacity();
+            blocks_.clear();
+            AddBlock(total);
+        }
+        used_ = 0;
+    }
+
+    size_t Arena::Capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+
+    void* Arena::do_allocate(size_t bytes, size_t alignment) {
+        auto offset_in = [&](const Block& block) {
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            return ((base + used_ + alignment - 1) & ~(alignment - 1)) - base;
+        };
+        size_t begin = offset_in(blocks_.back());
+        if (begin + bytes > blocks_.back().size) {
+            AddBlock(std::max(blocks_.back().size * 2, bytes + alignment));
+            begin = offset_in(blocks_.back());
+        }
+        used_ = begin + bytes;
+        return blocks_.back().data.get() + begin;
+    }
+
+    void Arena::do_deallocate(void*, size_t, size_t) {
+    }
+
+    bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+} // namespace ArgumentParser
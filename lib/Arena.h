@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Single-threaded bump allocator. Deallocation is a no-op; Reset frees
+    // everything at once and keeps the memory, so after a few parses of similar
+    // size it stops asking the upstream allocator for anything.
+    class Arena : public std::pmr::memory_resource {
+    public:
+        explicit Arena(size_t initial_size = 4096);
+
+        // Every pointer handed out before becomes invalid.
+        void Reset();
+        size_t Capacity() const;
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t size = 0;
+        };
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        void AddBlock(size_t size);
+
+        std::vector<Block> blocks_;
+        size_t used_ = 0; // bytes taken from the last block
+    };
+
+} // namespace ArgumentParser
@@ -1,66 +1,158 @@
 #pragma once
 
-#include "ArgSettings.h"
+#include "ParseResult.h"
+#include "Schema.h"
+#include "StreamParser.h"
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace ArgumentParser {
 
+    // Schema plus the result of the last Parse call, for code that wants a
+    // single object. New code that parses concurrently should share a Schema
+    // and keep one ParseResult per call instead.
     class ArgParser {
     public:
         explicit ArgParser(const std::string& name);
 
         bool Parse(const std::vector<std::string>& args);
         bool Parse(int argc, char** argv);
+        // Token-by-token parse into this parser's result, see StreamParser.
+        StreamParser Stream(StreamParser::CompletionHandler on_complete = {});
 
         ArgParser &AddStringArgument(const std::string& str, const std::string& description = "");
         ArgParser &AddStringArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
         ArgParser &AddIntArgument(const std::string& str, const std::string& description = "");
         ArgParser &AddIntArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        ArgParser &AddDoubleArgument(const std::string& str, const std::string& description = "");
+        ArgParser &AddDoubleArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        ArgParser &AddFloatArgument(const std::string& str, const std::string& description = "");
+        ArgParser &AddFloatArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
         ArgParser &AddFlag(const std::string& str, const std::string& description = "");
         ArgParser &AddFlag(const char& ch, const std::string& str2 = "", const std::string& description = "");
         ArgParser &AddHelp(const char& ch, const std::string& str2 = "", const std::string& description = "");
 
+        // See Schema::AddArgument<T>.
+        template <typename T>
+        ArgParser &AddArgument(const std::string& str, const std::string& description = "") {
+            schema_.AddArgument<T>(str, description);
+            return *this;
+        }
+
+        template <typename T>
+        ArgParser &AddArgument(const char& ch, const std::string& str2 = "", const std::string& description = "") {
+            schema_.AddArgument<T>(ch, str2, description);
+            return *this;
+        }
+
         ArgParser& MultiValue(size_t minimum_size = 0);
         ArgParser& StoreValues(std::vector<std::string>& container);
         ArgParser& StoreValues(std::vector<int>& container);
+        ArgParser& StoreValues(std::vector<double>& container);
+        ArgParser& StoreValues(std::vector<float>& container);
         ArgParser& StoreValue(std::string& value);
         ArgParser& StoreValue(int& value);
         ArgParser& StoreValue(bool& value);
+        ArgParser& StoreValue(double& value);
+        ArgParser& StoreValue(float& value);
+
+        template <typename T>
+        ArgParser& StoreValues(std::vector<T>& container) {
+            schema_.StoreValues(container);
+            return *this;
+        }
+
+        template <typename T>
+        ArgParser& StoreValue(T& value) {
+            schema_.StoreValue(value);
+            return *this;
+        }
         ArgParser& Positional();
+        // See ArgumentSettings::SetLazy.
+        ArgParser& Lazy();
+        // See ArgumentSettings::SetNonFinite.
+        ArgParser& NonFinite();
         ArgParser& Default(const char* value);
         ArgParser& Default(const int& value);
         ArgParser& Default(const bool& value);
+        ArgParser& Default(const double& value);
+
+        template <typename T>
+        ArgParser& Default(const T& value) {
+            schema_.Default(value);
+            return *this;
+        }
+        // See Schema::Env and Schema::ConfigFile.
+        ArgParser& Env(const std::string& variable);
+        ArgParser& ConfigFile(const std::string& path);
+        // See Schema::AddSubcommand; the subcommand's values are in
+        // GetSubcommandResult().
+        ArgParser& AddSubcommand(const std::string& name, Schema::SubcommandFactory factory,
+            const std::string& description = "");
+
+        bool GetFlag(const std::string& str) const;
+        bool GetFlag(const char ch) const;
+        int GetFlagCount(const std::string& str) const;
+        int GetFlagCount(const char ch) const;
+        int GetIntValue(const std::string& str, int ind = 0) const;
+        std::string GetStringValue(const std::string& str, int ind = 0) const;
+        double GetDoubleValue(const std::string& str, int ind = 0) const;
+        std::span<const int> GetIntValues(const std::string& str) const;
+        ArgumentSettings::StringRange GetStringValues(const std::string& str) const;
+        std::span<const double> GetDoubleValues(const std::string& str) const;
+        std::span<const float> GetFloatValues(const std::string& str) const;
 
-        bool GetFlag(const std::string str);
-        bool GetFlag(const char ch);
-        int GetIntValue(const std::string str, int ind = 0);
-        std::string GetStringValue(const std::string str, int ind = 0);
+        // See ParseResult::GetValue and ParseResult::GetValues.
+        template <typename T>
+        T GetValue(const std::string& str, int ind = 0) const {
+            return result_.GetValue<T>(str, ind);
+        }
+
+        template <typename T>
+        std::span<const T> GetValues(const std::string& str) const {
+            return result_.GetValues<T>(str);
+        }
+
+        // See Schema::Handle and ParseResult::Get.
+        template <typename T>
+        Option<T> Handle() const {
+            return schema_.Handle<T>();
+        }
+
+        template <typename T>
+        typename Option<T>::Value Get(Option<T> option, int ind = 0) const {
+            return result_.Get(option, ind);
+        }
+
+        template <typename T>
+        auto GetValues(Option<T> option) const {
+            return result_.GetValues(option);
+        }
+        ArgumentSettings::LazyIntRange GetLazyIntValues(const std::string& str) const;
+        std::string_view GetSubcommand() const;
+        const ParseResult* GetSubcommandResult() const;
         bool Help() const;
-        std::string HelpDescription();
+        // See ParseResult::GetErrors.
+        std::span<const ParseError> GetErrors() const;
+        size_t ErrorCount() const;
+        std::string HelpDescription() const;
+        void WriteHelp(std::ostream& out) const;
+        ArgParser& HelpWidth(size_t columns);
+
+        // See Schema::PreScan, Schema::ResponseFiles, Schema::ParallelConversion,
+        // Schema::Abbreviations and Schema::Freeze.
+        ArgParser& PreScan(bool enabled = true);
+        ArgParser& ResponseFiles(bool enabled = true);
+        ArgParser& ParallelConversion(size_t thread_count = 0, size_t min_values = Schema::kParallelMinValues);
+        ArgParser& Abbreviations(bool enabled = true);
+        ArgParser& Freeze();
+
+        const Schema& GetSchema() const;
+        const ParseResult& GetResult() const;
 
     private:
-        bool ProcessLongArg(const std::vector<std::string>& args, int& i, bool& is_help_arg);
-        bool ProcessLongArg(char** argv, int& i, int argc, bool& is_help_arg);
-        bool ProcessShortArg(const std::vector<std::string>& args, int& i, bool& is_help_arg);
-        bool ProcessShortArg(char** argv, int& i, int argc, bool& is_help_arg);
-        bool ProcessArgument(const std::string& name,
-            ArgumentSettings::Type type, int& i, int argc, const std::vector<std::string>& args);
-        bool ProcessArgument(const std::string& name,
-            ArgumentSettings::Type type, int& i, int argc, char** argv);
-        void ProcessPositionalArgument(const std::vector<std::string>& args,
-            int&i, bool &is_parsed);
-        void ProcessPositionalArgument(char** argv, int argc,
-            int&i, bool &is_parsed);
-        bool have_add_help_ = false;
-        std::unordered_map<std::string, ArgumentSettings> args_;
-        std::unordered_map<std::string, std::string> short_to_long_;
-        std::unordered_map<std::string, std::string> long_to_short_; //only for HelpDescription()
-        std::string parser_name_;
-        std::string last_added_;
-        std::string last_positional_;
-        std::string help_argument_;
+        Schema schema_;
+        ParseResult result_;
     };
 
 } // namespace ArgumentParser
@@ -1,44 +1,103 @@
 #pragma once
 
+#include "Convert.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
+// Parse state of one argument. Only the state of the argument's own type is
+// stored (one alternative of state_); names, descriptions and other help text
+// live in the Schema, so a settings record stays within two cache lines.
 class ArgumentSettings {
 public:
     enum class Type {
         String,
         Int,
-        Flag
+        Flag,
+        Double,
+        Float,
+        Custom, // any other type, see Custom<T>()
+        Int64,
+        UInt64,
+        UInt32
     };
 
-    ArgumentSettings() : type_(Type::Flag), description_("") {
+    // Types stored without type erasure, see NumberState.
+    template <typename T>
+    static constexpr bool kHasNumberState = std::is_same_v<T, double> || std::is_same_v<T, float> ||
+        std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t> || std::is_same_v<T, uint32_t>;
+
+    ArgumentSettings() : state_(FlagState()), add_token_(&StoreToken<FlagState>) {
+    }
+
+    // Parsed values are allocated from resource; the default value always uses
+    // the default allocator.
+    explicit ArgumentSettings(Type type, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : state_(MakeState(type, resource)), add_token_(TokenStoreFor(type)) {
     }
 
-    ArgumentSettings(Type type, const std::string& description)
-        : type_(type), description_(description) {
+    // Argument of type T, converted by ArgumentParser::ValueConverter<T>. The
+    // fixed-width integers of kHasNumberState get a typed state like Double;
+    // for other types only the value storage is type-erased, the conversion is
+    // compiled in for T.
+    template <typename T>
+    static ArgumentSettings Custom(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        if constexpr (kHasNumberState<T>) {
+            return ArgumentSettings(kNumberType<T>, resource);
+        } else {
+            ArgumentSettings settings;
+            settings.state_ = CustomState(std::make_unique<TypedValues<T>>(resource));
+            settings.add_token_ = &StoreCustomToken<T>;
+            return settings;
+        }
     }
 
     ArgumentSettings& SetDefaultValue(const std::string& value) {
-        default_string_value_ = value;
-        is_parametr_parsed = true;
+        if (StringState* state = std::get_if<StringState>(&state_)) {
+            state->default_value = value;
+        }
+        SetOptional();
         return *this;
     }
 
-    ArgumentSettings& SetDefaultValue(bool value) {
-        default_bool_value_ = value;
-        is_parametr_parsed = true;
+    // Any other T: the default of a Custom<T>() argument, or an arithmetic
+    // value (bool, int, double, ...) converted to the argument's own type, so
+    // Default(7) also sets an int64_t or Double argument.
+    template <typename T>
+        requires(!std::is_convertible_v<const T&, std::string>)
+    ArgumentSettings& SetDefaultValue(const T& value) {
+        std::visit([&](auto& state) {
+            using State = std::decay_t<decltype(state)>;
+            if constexpr (std::is_same_v<State, CustomState>) {
+                if (TypedValues<T>* typed = state.template As<T>()) {
+                    typed->default_value = value;
+                }
+            } else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<State, StringState>) {
+                state.default_value = static_cast<decltype(state.default_value)>(value);
+            }
+        }, state_);
+        SetOptional();
         return *this;
     }
 
-    ArgumentSettings& SetDefaultValue(int value) {
-        default_int_value_ = value;
+    // The argument may be omitted from the command line.
+    ArgumentSettings& SetOptional() {
+        is_optional_ = true;
         is_parametr_parsed = true;
         return *this;
     }
 
     ArgumentSettings& SetMultiValue(size_t min_count = 0) {
         is_multi_value_ = true;
-        min_count_ = min_count;
+        min_count_ = static_cast<uint32_t>(min_count);
         return *this;
     }
 
@@ -47,157 +106,593 @@ public:
         return *this;
     }
 
+    // Int values are kept as text and converted only when they are read, see
+    // GetLazyIntValues. Ignored while the values are bound with StoreValue(s).
+    ArgumentSettings& SetLazy() {
+        is_lazy_ = true;
+        return *this;
+    }
+
+    // Double and Float values may be "inf" or "nan", which ConvertReal
+    // rejects by default.
+    ArgumentSettings& SetNonFinite() {
+        is_non_finite_ = true;
+        return *this;
+    }
+
     ArgumentSettings& SetStoreValues(std::vector<std::string>& container) {
-        string_reference_container_ = &container;
+        if (StringState* state = std::get_if<StringState>(&state_)) {
+            state->reference_container = &container;
+        }
         return *this;
     }
 
     ArgumentSettings& SetStoreValues(std::vector<int>& container) {
-        int_reference_container_ = &container;
+        if (IntState* state = std::get_if<IntState>(&state_)) {
+            state->reference_container = &container;
+        }
+        return *this;
+    }
+
+    ArgumentSettings& SetStoreValues(std::vector<double>& container) {
+        return SetNumberStoreValues(container);
+    }
+
+    ArgumentSettings& SetStoreValues(std::vector<float>& container) {
+        return SetNumberStoreValues(container);
+    }
+
+    template <typename T>
+    ArgumentSettings& SetStoreValues(std::vector<T>& container) {
+        if constexpr (kHasNumberState<T>) {
+            return SetNumberStoreValues(container);
+        } else if (TypedValues<T>* typed = CustomAs<T>()) {
+            typed->reference_container = &container;
+        }
         return *this;
     }
 
     ArgumentSettings& SetStoreValue(std::string& value) {
-        string_reference_ = &value;
+        if (StringState* state = std::get_if<StringState>(&state_)) {
+            state->reference = &value;
+        }
         return *this;
     }
 
     ArgumentSettings& SetStoreValue(int& value) {
-        int_reference_ = &value;
+        if (IntState* state = std::get_if<IntState>(&state_)) {
+            state->reference = &value;
+        }
         return *this;
     }
 
     ArgumentSettings& SetStoreValue(bool& value) {
-        bool_reference_ = &value;
+        if (FlagState* state = std::get_if<FlagState>(&state_)) {
+            state->reference = &value;
+        }
+        return *this;
+    }
+
+    ArgumentSettings& SetStoreValue(double& value) {
+        return SetNumberStoreValue(value);
+    }
+
+    ArgumentSettings& SetStoreValue(float& value) {
+        return SetNumberStoreValue(value);
+    }
+
+    template <typename T>
+    ArgumentSettings& SetStoreValue(T& value) {
+        if constexpr (kHasNumberState<T>) {
+            return SetNumberStoreValue(value);
+        } else if (TypedValues<T>* typed = CustomAs<T>()) {
+            typed->reference = &value;
+        }
         return *this;
     }
 
-    ArgumentSettings& AddValue(const std::string& value) {
+    // Copy of the definition (type, arity, defaults) without parsed values;
+    // the StoreValue(s) references are copied only if keep_bindings is set.
+    ArgumentSettings CloneDefinition(bool keep_bindings = false,
+                                     std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        ArgumentSettings clone(GetType(), resource);
+        clone.add_token_ = add_token_;
+        std::visit([&](auto& to) {
+            const auto& from = std::get<std::decay_t<decltype(to)>>(state_);
+            if constexpr (std::is_same_v<std::decay_t<decltype(to)>, CustomState>) {
+                if (from.values) {
+                    to.values = from.values->CloneDefinition(keep_bindings, resource);
+                }
+                to.type = from.type;
+            } else {
+                to.default_value = from.default_value;
+                if (keep_bindings) {
+                    to.reference = from.reference;
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(to)>, FlagState>) {
+                        to.reference_container = from.reference_container;
+                    }
+                }
+            }
+        }, clone.state_);
+        clone.is_positional_ = is_positional_;
+        clone.is_multi_value_ = is_multi_value_;
+        clone.is_lazy_ = is_lazy_;
+        clone.is_non_finite_ = is_non_finite_;
+        clone.min_count_ = min_count_;
+        clone.is_optional_ = is_optional_;
+        clone.is_parametr_parsed = is_optional_;
+        return clone;
+    }
+
+    // Forgets the values of the previous parse. The internal containers keep
+    // their capacity so reused settings do not allocate again, unless
+    // release_storage is set: then all memory goes back to the resource, which
+    // has to be done before a monotonic resource is reset.
+    void ResetValues(bool release_storage = false) {
+        is_parametr_parsed = is_optional_;
+        is_given_ = false;
+        vector_size_ = 0;
+        counted_values_ = 0;
+        std::visit([&](auto& state) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(state)>, FlagState>) {
+                state.has_value = false;
+                state.count = 0;
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(state)>, CustomState>) {
+                if (state.values) {
+                    state.values->Clear(release_storage);
+                }
+            } else if (release_storage) {
+                state.values = decltype(state.values)(state.values.get_allocator());
+                if constexpr (std::is_same_v<std::decay_t<decltype(state)>, IntState>) {
+                    state.texts = decltype(state.texts)(state.texts.get_allocator());
+                }
+            } else {
+                state.values.clear();
+                if constexpr (std::is_same_v<std::decay_t<decltype(state)>, IntState>) {
+                    state.texts.clear();
+                }
+            }
+        }, state_);
+    }
+
+    // Pre-scan support: CountValue announces one more value of the coming
+    // parse, ReserveCounted makes room for all announced values at once.
+    void CountValue() {
+        ++counted_values_;
+    }
+
+    void ReserveCounted() {
+        if (is_multi_value_ && counted_values_ > 0) {
+            std::visit([&](auto& state) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(state)>, CustomState>) {
+                    if (state.values) {
+                        state.values->Reserve(counted_values_);
+                    }
+                } else if constexpr (!std::is_same_v<std::decay_t<decltype(state)>, FlagState>) {
+                    if (state.reference_container) {
+                        state.reference_container->reserve(state.reference_container->size() + counted_values_);
+                    } else if (IsLazy()) {
+                        std::get<IntState>(state_).texts.reserve(counted_values_);
+                    } else {
+                        state.values.reserve(state.values.size() + counted_values_);
+                    }
+                }
+            }, state_);
+        }
+        counted_values_ = 0;
+    }
+
+    ArgumentSettings& AddValue(std::string_view value) {
+        StringState* state = std::get_if<StringState>(&state_);
+        if (state == nullptr) {
+            return *this;
+        }
         if (is_multi_value_) {
             vector_size_++;
-            if (string_reference_container_) {
-                string_reference_container_->push_back(value);
+            if (state->reference_container) {
+                state->reference_container->emplace_back(value);
             } else {
-                if (string_container_ == nullptr) {
-                    string_container_ = std::make_unique<std::vector<std::string> >();
-                }
-                string_container_->push_back(value);
+                state->values.emplace_back(value);
             }
         } else {
-            if (string_reference_) {
-                *string_reference_ = value;
+            if (state->reference) {
+                *state->reference = value;
             } else {
-                if (string_value_ == nullptr) {
-                    string_value_ = std::make_unique<std::string>();
-                }
-                *string_value_ = value;
+                state->values.clear();
+                state->values.emplace_back(value);
             }
         }
         return *this;
     }
 
     ArgumentSettings& AddValue(int value) {
+        IntState* state = std::get_if<IntState>(&state_);
+        if (state == nullptr) {
+            return *this;
+        }
         if (is_multi_value_) {
             vector_size_++;
-            if (int_reference_container_) {
-                int_reference_container_->push_back(value);
+            if (state->reference_container) {
+                state->reference_container->push_back(value);
             } else {
-                if (int_container_ == nullptr) {
-                    int_container_ = std::make_unique<std::vector<int> >();
-                }
-                int_container_->push_back(value);
+                state->values.push_back(value);
             }
         } else {
-            if (int_reference_) {
-                *int_reference_ = value;
+            if (state->reference) {
+                *state->reference = value;
             } else {
-                if (int_value_ == nullptr) {
-                    int_value_ = std::make_unique<int>();
+                state->values.clear();
+                state->values.push_back(value);
+            }
+        }
+        return *this;
+    }
+
+    ArgumentSettings& AddValue(double value) {
+        return AddNumberValue(value);
+    }
+
+    ArgumentSettings& AddValue(float value) {
+        return AddNumberValue(value);
+    }
+
+    // Bulk conversion support for multi-value numeric arguments (IsNumeric):
+    // appends count value-initialized values and returns them for the caller to
+    // fill in place. Empty if Value does not match the type.
+    template <typename Value>
+    std::span<Value> AppendValues(size_t count) {
+        return std::visit([&](auto& state) -> std::span<Value> {
+            using State = std::decay_t<decltype(state)>;
+            if constexpr (std::is_same_v<State, IntState> || std::is_same_v<State, NumberState<Value>>) {
+                if constexpr (std::is_same_v<decltype(state.values), std::pmr::vector<Value>>) {
+                    vector_size_ += static_cast<uint32_t>(count);
+                    if (state.reference_container) {
+                        state.reference_container->resize(state.reference_container->size() + count);
+                        return std::span<Value>(*state.reference_container).last(count);
+                    }
+                    state.values.resize(state.values.size() + count);
+                    return std::span<Value>(state.values).last(count);
                 }
-                *int_value_ = value;
             }
+            return {};
+        }, state_);
+    }
+
+    // Takes back the last count values given out by AppendValues.
+    void DropValues(size_t count) {
+        vector_size_ -= static_cast<uint32_t>(count);
+        std::visit([&](auto& state) {
+            using State = std::decay_t<decltype(state)>;
+            if constexpr (!std::is_same_v<State, FlagState> && !std::is_same_v<State, CustomState>) {
+                if (state.reference_container) {
+                    state.reference_container->resize(state.reference_container->size() - count);
+                } else {
+                    state.values.resize(state.values.size() - count);
+                }
+            }
+        }, state_);
+    }
+
+    // Converts token with the converter bound to the argument's type when it
+    // was created and stores the value; false if the token is not a valid
+    // value. Flags take any token as true. Lazy Int values go through
+    // AddLazyValue instead.
+    bool AddTokenValue(std::string_view token) {
+        return add_token_(*this, token);
+    }
+
+    // Stores the unconverted text of an Int value of a lazy argument.
+    ArgumentSettings& AddLazyValue(std::string_view text) {
+        IntState& state = std::get<IntState>(state_);
+        if (is_multi_value_) {
+            vector_size_++;
+        } else {
+            state.texts.clear();
         }
+        state.texts.emplace_back(text);
         return *this;
     }
 
     ArgumentSettings& AddValue(bool value) {
-        if (bool_reference_) {
-            *bool_reference_ = value;
+        FlagState* state = std::get_if<FlagState>(&state_);
+        if (state == nullptr) {
+            return *this;
+        }
+        state->count += value;
+        if (state->reference) {
+            *state->reference = value;
         } else {
-            if (bool_value_ == nullptr) {
-                bool_value_ = std::make_unique<bool>();
-            }
-            *bool_value_ = value;
+            state->value = value;
+            state->has_value = true;
         }
         return *this;
     }
 
     bool GetBoolValue() const {
-        if (bool_reference_) {
-            return *bool_reference_;
+        const FlagState* state = std::get_if<FlagState>(&state_);
+        if (state == nullptr) {
+            return false;
         }
-        if (bool_value_ == nullptr) {
-            return default_bool_value_;
+        if (state->reference) {
+            return *state->reference;
         }
-        return *bool_value_;
+        if (!state->has_value) {
+            return state->default_value;
+        }
+        return state->value;
     }
 
     int GetIntVal(int index = 0) const {
+        const IntState* state = std::get_if<IntState>(&state_);
+        if (state == nullptr) {
+            return 0;
+        }
         if (is_multi_value_) {
-            if (int_reference_container_ && int_reference_container_->size() > index) {
-                return (*int_reference_container_)[index];
+            size_t position = static_cast<size_t>(index);
+            if (state->reference_container && state->reference_container->size() > position) {
+                return (*state->reference_container)[position];
+            }
+            if (state->values.size() > position) {
+                return state->values[position];
+            }
+            if (state->texts.size() > position) {
+                return TryGetIntVal(index).value_or(state->default_value);
+            }
+            return state->default_value;
+        }
+        if (state->reference) {
+            return *state->reference;
+        }
+        if (!state->texts.empty()) {
+            return TryGetIntVal(0).value_or(state->default_value);
+        }
+        if (state->values.empty()) {
+            return state->default_value;
+        }
+        return state->values.front();
+    }
+
+    // Value of a Double or Float argument.
+    double GetDoubleVal(int index = 0) const {
+        if (const NumberState<float>* state = std::get_if<NumberState<float>>(&state_)) {
+            return GetRealVal(*state, index);
+        }
+        const NumberState<double>* state = std::get_if<NumberState<double>>(&state_);
+        return state != nullptr ? GetRealVal(*state, index) : 0.0;
+    }
+
+    // Like GetIntValues, for Double and Float arguments respectively.
+    std::span<const double> GetDoubleValues() const {
+        return GetNumberValues<double>();
+    }
+
+    std::span<const float> GetFloatValues() const {
+        return GetNumberValues<float>();
+    }
+
+    // Value of a Custom<T>() argument, the default if index is past the
+    // values; nullptr if the argument is not of type T.
+    template <typename T>
+    const T* GetCustomValue(int index = 0) const {
+        if constexpr (kHasNumberState<T>) {
+            return Holds<T>() ? &GetValueRef<T>(index) : nullptr;
+        } else {
+            const TypedValues<T>* typed = CustomAs<T>();
+            return typed != nullptr ? &typed->Get(static_cast<size_t>(index), is_multi_value_) : nullptr;
+        }
+    }
+
+    template <typename T>
+    std::span<const T> GetCustomValues() const {
+        if constexpr (kHasNumberState<T>) {
+            return GetNumberValues<T>();
+        } else {
+            const TypedValues<T>* typed = CustomAs<T>();
+            return typed != nullptr ? typed->All(is_multi_value_) : std::span<const T>();
+        }
+    }
+
+    // Whether the argument holds values of type T, as AddArgument<T> defines
+    // them.
+    template <typename T>
+    bool Holds() const {
+        if constexpr (std::is_same_v<T, bool>) {
+            return GetType() == Type::Flag;
+        } else if constexpr (std::is_same_v<T, int>) {
+            return GetType() == Type::Int;
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return GetType() == Type::String;
+        } else if constexpr (kHasNumberState<T>) {
+            return std::holds_alternative<NumberState<T>>(state_);
+        } else {
+            return CustomAs<T>() != nullptr;
+        }
+    }
+
+    // Value without copying, the default if index is past the values; lazy
+    // Int arguments give their default. The argument has to hold T values
+    // other than bool or std::string (see Holds), which is not checked again.
+    template <typename T>
+    const T& GetValueRef(int index = 0) const {
+        size_t position = static_cast<size_t>(index);
+        if constexpr (std::is_same_v<T, int>) {
+            std::span<const int> values = GetIntValues();
+            return position < values.size() ? values[position] : std::get<IntState>(state_).default_value;
+        } else if constexpr (kHasNumberState<T>) {
+            std::span<const T> values = GetNumberValues<T>();
+            return position < values.size() ? values[position] : std::get<NumberState<T>>(state_).default_value;
+        } else {
+            const CustomState& state = *std::get_if<CustomState>(&state_);
+            return static_cast<const TypedValues<T>&>(*state.values).Get(position, is_multi_value_);
+        }
+    }
+
+    // Value placeholder for the help text: "int", "string", ..., empty for flags.
+    std::string_view GetTypeName() const {
+        switch (GetType()) {
+            case Type::String:
+                return "string";
+            case Type::Int:
+                return "int";
+            case Type::Double:
+                return "double";
+            case Type::Float:
+                return "float";
+            case Type::Int64:
+            case Type::UInt64:
+            case Type::UInt32:
+                return "int";
+            case Type::Custom: {
+                const CustomState& state = std::get<CustomState>(state_);
+                return state.values ? state.values->TypeName() : "value";
             }
-            if (int_container_ && int_container_->size() > index) {
-                return (*int_container_)[index];
+            default:
+                return {};
+        }
+    }
+
+    // Like GetIntVal, but converts the value of a lazy argument here and
+    // returns nullopt if its text is not a valid int.
+    std::optional<int> TryGetIntVal(int index = 0) const {
+        const IntState* state = std::get_if<IntState>(&state_);
+        if (state == nullptr || state->texts.size() <= static_cast<size_t>(index)) {
+            return GetIntVal(index);
+        }
+        int value;
+        if (!ArgumentParser::ConvertInteger(std::string_view(state->texts[index]), value)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Number of values GetIntVal/GetStringView can be asked for: the stored
+    // values of a multi-value argument, otherwise one (possibly the default).
+    int GetValueCount() const {
+        if (!is_multi_value_) {
+            return 1;
+        }
+        return std::visit([](const auto& state) -> int {
+            if constexpr (std::is_same_v<std::decay_t<decltype(state)>, FlagState>) {
+                return 1;
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(state)>, CustomState>) {
+                return state.values ? static_cast<int>(state.values->Size()) : 0;
+            } else {
+                if (state.reference_container) {
+                    return static_cast<int>(state.reference_container->size());
+                }
+                if constexpr (std::is_same_v<std::decay_t<decltype(state)>, IntState>) {
+                    if (!state.texts.empty()) {
+                        return static_cast<int>(state.texts.size());
+                    }
+                }
+                return static_cast<int>(state.values.size());
             }
-            return default_int_value_;
+        }, state_);
+    }
+
+    // Converted Int values without copying; empty for lazy arguments, which
+    // have to be read through GetLazyIntValues.
+    std::span<const int> GetIntValues() const {
+        const IntState* state = std::get_if<IntState>(&state_);
+        if (state == nullptr || !state->texts.empty()) {
+            return {};
         }
-        if (int_reference_) {
-            return *int_reference_;
+        if (state->reference_container) {
+            return *state->reference_container;
         }
-        if (int_value_ == nullptr) {
-            return default_int_value_;
+        if (!is_multi_value_) {
+            if (state->reference) {
+                return std::span<const int>(state->reference, 1);
+            }
+            return state->values.empty() ? std::span<const int>(&state->default_value, 1) : std::span<const int>(state->values);
         }
-        return *int_value_;
+        return state->values;
+    }
+
+    struct StringAt {
+        const ArgumentSettings* setting = nullptr;
+
+        std::string_view operator()(int index) const {
+            return setting->GetStringView(index);
+        }
+    };
+
+    struct LazyIntAt {
+        const ArgumentSettings* setting = nullptr;
+
+        std::optional<int> operator()(int index) const {
+            return setting->TryGetIntVal(index);
+        }
+    };
+
+    // Random-access views over the values; they stay valid as long as the
+    // settings are not parsed into again.
+    using StringRange = std::ranges::transform_view<std::ranges::iota_view<int, int>, StringAt>;
+    using LazyIntRange = std::ranges::transform_view<std::ranges::iota_view<int, int>, LazyIntAt>;
+
+    StringRange GetStringValues() const {
+        return StringRange(std::views::iota(0, GetValueCount()), StringAt{this});
+    }
+
+    LazyIntRange GetLazyIntValues() const {
+        return LazyIntRange(std::views::iota(0, GetValueCount()), LazyIntAt{this});
     }
 
     std::string GetStringVal(int index = 0) const {
+        return std::string(GetStringView(index));
+    }
+
+    std::string_view GetStringView(int index = 0) const {
+        const StringState* state = std::get_if<StringState>(&state_);
+        if (state == nullptr) {
+            return {};
+        }
         if (is_multi_value_) {
-            if (string_reference_container_ && string_reference_container_->size() > index) {
-                return (*string_reference_container_)[index];
+            size_t position = static_cast<size_t>(index);
+            if (state->reference_container && state->reference_container->size() > position) {
+                return (*state->reference_container)[position];
             }
-            if (string_container_ && string_container_->size() > index) {
-                return (*string_container_)[index];
+            if (state->values.size() > position) {
+                return state->values[position];
             }
-            return default_string_value_;
+            return state->default_value;
         }
-        if (string_reference_) {
-            return *string_reference_;
+        if (state->reference) {
+            return *state->reference;
         }
-        if (string_value_ == nullptr) {
-            return default_string_value_;
+        if (state->values.empty()) {
+            return state->default_value;
         }
-        return *string_value_;
+        return state->values.front();
     }
 
-    const std::string &GetDefaultValueString() const {
-        return default_string_value_;
+    std::string GetDefaultValueString() const {
+        const StringState* state = std::get_if<StringState>(&state_);
+        return state != nullptr ? state->default_value : std::string();
     }
 
-    const std::string &GetDescription() const {
-        return description_;
+    int GetSize() const {
+        return static_cast<int>(vector_size_);
     }
 
-    int GetSize() const {
-        return vector_size_;
+    int GetFlagCount() const {
+        const FlagState* state = std::get_if<FlagState>(&state_);
+        return state != nullptr ? state->count : 0;
     }
 
     int GetDefaultValueInt() const {
-        return default_int_value_;
+        const IntState* state = std::get_if<IntState>(&state_);
+        return state != nullptr ? state->default_value : 0;
     }
 
     void SetParameterParsed() {
         is_parametr_parsed = true;
+        is_given_ = true;
+    }
+
+    // The argument got a value in this parse, as opposed to being optional.
+    bool IsGiven() const {
+        return is_given_;
     }
 
     bool IsParamParsed() const {
@@ -212,8 +707,19 @@ public:
         return is_positional_;
     }
 
+    // True if Int values are to be stored as text, see SetLazy.
+    bool IsLazy() const {
+        const IntState* state = std::get_if<IntState>(&state_);
+        return is_lazy_ && state != nullptr && state->reference == nullptr && state->reference_container == nullptr;
+    }
+
+    bool AllowsNonFinite() const {
+        return is_non_finite_;
+    }
+
     bool GetDefaultValueBool() const {
-        return default_bool_value_;
+        const FlagState* state = std::get_if<FlagState>(&state_);
+        return state != nullptr && state->default_value;
     }
 
     size_t GetMinCount() const {
@@ -221,37 +727,395 @@ public:
     }
 
     Type GetType() const {
-        return type_;
+        return static_cast<Type>(state_.index());
+    }
+
+    // Int, Double, Float and the fixed-width integers: the types whose values
+    // AppendValues hands out for bulk conversion.
+    bool IsNumeric() const {
+        return std::visit([](const auto& state) {
+            using State = std::decay_t<decltype(state)>;
+            return std::is_same_v<State, IntState> || requires { typename State::Value; };
+        }, state_);
     }
 
 private:
-    Type type_;
+    // A single value is kept as values[0], so the same storage serves both
+    // arities.
+    struct StringState {
+        std::string* reference = nullptr;
+        std::vector<std::string>* reference_container = nullptr;
+        std::pmr::vector<std::pmr::string> values;
+        std::string default_value;
+    };
 
-    bool default_bool_value_ = false;
-    bool is_positional_ = false;
-    bool is_parametr_parsed = false;
-    bool is_multi_value_ = false;
+    struct IntState {
+        int* reference = nullptr;
+        std::vector<int>* reference_container = nullptr;
+        std::pmr::vector<int> values;
+        std::pmr::vector<std::pmr::string> texts; // values of a lazy argument
+        int default_value = 0;
+    };
+
+    struct FlagState {
+        bool* reference = nullptr;
+        int count = 0;
+        bool default_value = false;
+        bool value = false;
+        bool has_value = false;
+    };
+
+    // Double, Float and the fixed-width integers of kHasNumberState.
+    template <typename Number>
+    struct NumberState {
+        using Value = Number;
+
+        Number* reference = nullptr;
+        std::vector<Number>* reference_container = nullptr;
+        std::pmr::vector<Number> values;
+        Number default_value = 0;
+    };
+
+    // Storage of a Custom<T>() argument. Only this interface is virtual;
+    // TypedValues<T> calls ValueConverter<T> directly.
+    class CustomValues {
+    public:
+        virtual ~CustomValues() = default;
+        virtual std::unique_ptr<CustomValues> Clone() const = 0;
+        virtual std::unique_ptr<CustomValues> CloneDefinition(bool keep_bindings, std::pmr::memory_resource* resource) const = 0;
+        virtual bool Add(std::string_view token, bool is_multi_value) = 0;
+        virtual void Clear(bool release_storage) = 0;
+        virtual void Reserve(size_t count) = 0;
+        virtual size_t Size() const = 0;
+        virtual std::string_view TypeName() const = 0;
+    };
+
+    template <typename T>
+    class TypedValues final : public CustomValues {
+    public:
+        using Converter = ArgumentParser::ValueConverter<T>;
 
-    bool* bool_reference_ = nullptr;
+        explicit TypedValues(std::pmr::memory_resource* resource) : values(resource) {
+        }
+
+        std::unique_ptr<CustomValues> Clone() const override {
+            return std::make_unique<TypedValues>(*this);
+        }
+
+        std::unique_ptr<CustomValues> CloneDefinition(bool keep_bindings, std::pmr::memory_resource* resource) const override {
+            auto clone = std::make_unique<TypedValues>(resource);
+            clone->default_value = default_value;
+            if (keep_bindings) {
+                clone->reference = reference;
+                clone->reference_container = reference_container;
+            }
+            return clone;
+        }
+
+        bool Add(std::string_view token, bool is_multi_value) override {
+            T value{};
+            if (!Converter::Convert(token, value)) {
+                return false;
+            }
+            if (is_multi_value) {
+                if (reference_container) {
+                    reference_container->push_back(std::move(value));
+                } else {
+                    values.push_back(std::move(value));
+                }
+            } else if (reference) {
+                *reference = std::move(value);
+            } else {
+                values.clear();
+                values.push_back(std::move(value));
+            }
+            return true;
+        }
+
+        void Clear(bool release_storage) override {
+            if (release_storage) {
+                values = std::pmr::vector<T>(values.get_allocator());
+            } else {
+                values.clear();
+            }
+        }
+
+        void Reserve(size_t count) override {
+            if (reference_container) {
+                reference_container->reserve(reference_container->size() + count);
+            } else {
+                values.reserve(values.size() + count);
+            }
+        }
 
-    int* int_reference_ = nullptr;
+        size_t Size() const override {
+            return reference_container ? reference_container->size() : values.size();
+        }
 
-    int default_int_value_ = 0;
-    int vector_size_ = 0;
+        std::string_view TypeName() const override {
+            if constexpr (requires { Converter::kTypeName; }) {
+                return Converter::kTypeName;
+            } else {
+                return "value";
+            }
+        }
 
-    size_t min_count_ = 0;
+        const T& Get(size_t index, bool is_multi_value) const {
+            if (is_multi_value) {
+                if (reference_container && reference_container->size() > index) {
+                    return (*reference_container)[index];
+                }
+                return values.size() > index ? values[index] : default_value;
+            }
+            if (reference) {
+                return *reference;
+            }
+            return values.empty() ? default_value : values.front();
+        }
+
+        std::span<const T> All(bool is_multi_value) const {
+            if (reference_container) {
+                return *reference_container;
+            }
+            if (!is_multi_value) {
+                return std::span<const T>(&Get(0, false), 1);
+            }
+            return values;
+        }
 
-    std::string description_;
-    std::string default_string_value_;
+        T* reference = nullptr;
+        std::vector<T>* reference_container = nullptr;
+        std::pmr::vector<T> values;
+        T default_value{};
+    };
 
-    std::vector<std::string>* string_reference_container_ = nullptr;
-    std::vector<int>* int_reference_container_ = nullptr;
-    std::string* string_reference_ = nullptr;
+    // The address of kTypeTag<T> identifies T without RTTI.
+    template <typename T>
+    static constexpr char kTypeTag = 0;
 
+    struct CustomState {
+        CustomState() = default;
 
-    std::unique_ptr<std::vector<std::string> > string_container_ = nullptr;
-    std::unique_ptr<std::vector<int> > int_container_ = nullptr;
-    std::unique_ptr<std::string> string_value_ = nullptr;
-    std::unique_ptr<int> int_value_ = nullptr;
-    std::unique_ptr<bool> bool_value_ = nullptr;
+        template <typename T>
+        explicit CustomState(std::unique_ptr<TypedValues<T>> custom_values)
+            : values(std::move(custom_values)), type(&kTypeTag<T>) {
+        }
+
+        CustomState(const CustomState& other) : values(other.values ? other.values->Clone() : nullptr), type(other.type) {
+        }
+
+        CustomState& operator=(const CustomState& other) {
+            values = other.values ? other.values->Clone() : nullptr;
+            type = other.type;
+            return *this;
+        }
+
+        CustomState(CustomState&&) noexcept = default;
+        CustomState& operator=(CustomState&&) noexcept = default;
+
+        template <typename T>
+        TypedValues<T>* As() const {
+            return type == &kTypeTag<T> ? static_cast<TypedValues<T>*>(values.get()) : nullptr;
+        }
+
+        std::unique_ptr<CustomValues> values;
+        const char* type = nullptr; // kTypeTag of the value type
+    };
+
+    // alternatives in the order of Type
+    using State = std::variant<StringState, IntState, FlagState, NumberState<double>, NumberState<float>, CustomState,
+                               NumberState<int64_t>, NumberState<uint64_t>, NumberState<uint32_t>>;
+
+    template <typename T>
+    TypedValues<T>* CustomAs() {
+        CustomState* state = std::get_if<CustomState>(&state_);
+        return state != nullptr ? state->template As<T>() : nullptr;
+    }
+
+    template <typename T>
+    const TypedValues<T>* CustomAs() const {
+        const CustomState* state = std::get_if<CustomState>(&state_);
+        return state != nullptr ? state->template As<T>() : nullptr;
+    }
+
+    template <typename T>
+    static constexpr Type kNumberType = std::is_same_v<T, double> ? Type::Double
+        : std::is_same_v<T, float> ? Type::Float
+        : std::is_same_v<T, int64_t> ? Type::Int64
+        : std::is_same_v<T, uint64_t> ? Type::UInt64 : Type::UInt32;
+
+    // Converts and stores one token; bound per argument, see AddTokenValue.
+    using TokenStore = bool (*)(ArgumentSettings& setting, std::string_view token);
+
+    template <typename Alternative>
+    static bool StoreToken(ArgumentSettings& setting, std::string_view token) {
+        if constexpr (std::is_same_v<Alternative, StringState>) {
+            setting.AddValue(token);
+        } else if constexpr (std::is_same_v<Alternative, FlagState>) {
+            setting.AddValue(true);
+        } else if constexpr (std::is_same_v<Alternative, IntState>) {
+            int value;
+            if (!ArgumentParser::ConvertInteger(token, value)) {
+                return false;
+            }
+            setting.AddValue(value);
+        } else {
+            using Value = typename Alternative::Value;
+            Value value;
+            if constexpr (std::is_floating_point_v<Value>) {
+                if (!ArgumentParser::ConvertReal(token, value, setting.is_non_finite_)) {
+                    return false;
+                }
+            } else if (!ArgumentParser::ValueConverter<Value>::Convert(token, value)) {
+                return false;
+            }
+            setting.AddNumberValue(value);
+        }
+        return true;
+    }
+
+    template <typename T>
+    static bool StoreCustomToken(ArgumentSettings& setting, std::string_view token) {
+        // TypedValues is final, so Add is called directly
+        auto& values = static_cast<TypedValues<T>&>(*std::get_if<CustomState>(&setting.state_)->values);
+        if (!values.Add(token, setting.is_multi_value_)) {
+            return false;
+        }
+        setting.vector_size_ += setting.is_multi_value_;
+        return true;
+    }
+
+    static TokenStore TokenStoreFor(Type type) {
+        switch (type) {
+            case Type::String:
+                return &StoreToken<StringState>;
+            case Type::Int:
+                return &StoreToken<IntState>;
+            case Type::Double:
+                return &StoreToken<NumberState<double>>;
+            case Type::Float:
+                return &StoreToken<NumberState<float>>;
+            case Type::Int64:
+                return &StoreToken<NumberState<int64_t>>;
+            case Type::UInt64:
+                return &StoreToken<NumberState<uint64_t>>;
+            case Type::UInt32:
+                return &StoreToken<NumberState<uint32_t>>;
+            default:
+                // Custom<T>() binds its own
+                return &StoreToken<FlagState>;
+        }
+    }
+
+    static State MakeState(Type type, std::pmr::memory_resource* resource) {
+        switch (type) {
+            case Type::String:
+                return StringState{.values = std::pmr::vector<std::pmr::string>(resource), .default_value = {}};
+            case Type::Int:
+                return IntState{.values = std::pmr::vector<int>(resource),
+                                .texts = std::pmr::vector<std::pmr::string>(resource)};
+            case Type::Double:
+                return NumberState<double>{.values = std::pmr::vector<double>(resource)};
+            case Type::Float:
+                return NumberState<float>{.values = std::pmr::vector<float>(resource)};
+            case Type::Int64:
+                return NumberState<int64_t>{.values = std::pmr::vector<int64_t>(resource)};
+            case Type::UInt64:
+                return NumberState<uint64_t>{.values = std::pmr::vector<uint64_t>(resource)};
+            case Type::UInt32:
+                return NumberState<uint32_t>{.values = std::pmr::vector<uint32_t>(resource)};
+            case Type::Custom:
+                return CustomState();
+            default:
+                return FlagState();
+        }
+    }
+
+    template <typename Number>
+    ArgumentSettings& SetNumberStoreValues(std::vector<Number>& container) {
+        if (NumberState<Number>* state = std::get_if<NumberState<Number>>(&state_)) {
+            state->reference_container = &container;
+        }
+        return *this;
+    }
+
+    template <typename Number>
+    ArgumentSettings& SetNumberStoreValue(Number& value) {
+        if (NumberState<Number>* state = std::get_if<NumberState<Number>>(&state_)) {
+            state->reference = &value;
+        }
+        return *this;
+    }
+
+    template <typename Number>
+    ArgumentSettings& AddNumberValue(Number value) {
+        NumberState<Number>* state = std::get_if<NumberState<Number>>(&state_);
+        if (state == nullptr) {
+            return *this;
+        }
+        if (is_multi_value_) {
+            vector_size_++;
+            if (state->reference_container) {
+                state->reference_container->push_back(value);
+            } else {
+                state->values.push_back(value);
+            }
+        } else if (state->reference) {
+            *state->reference = value;
+        } else {
+            state->values.clear();
+            state->values.push_back(value);
+        }
+        return *this;
+    }
+
+    template <typename Real>
+    double GetRealVal(const NumberState<Real>& state, int index) const {
+        size_t position = static_cast<size_t>(index);
+        if (is_multi_value_) {
+            if (state.reference_container && state.reference_container->size() > position) {
+                return (*state.reference_container)[position];
+            }
+            return state.values.size() > position ? state.values[position] : state.default_value;
+        }
+        if (state.reference) {
+            return *state.reference;
+        }
+        return state.values.empty() ? state.default_value : state.values.front();
+    }
+
+    template <typename Number>
+    std::span<const Number> GetNumberValues() const {
+        const NumberState<Number>* state = std::get_if<NumberState<Number>>(&state_);
+        if (state == nullptr) {
+            return {};
+        }
+        if (state->reference_container) {
+            return *state->reference_container;
+        }
+        if (!is_multi_value_) {
+            if (state->reference) {
+                return std::span<const Number>(state->reference, 1);
+            }
+            return state->values.empty() ? std::span<const Number>(&state->default_value, 1) : std::span<const Number>(state->values);
+        }
+        return state->values;
+    }
+
+    State state_;
+    TokenStore add_token_;
+    uint32_t min_count_ = 0;
+    uint32_t vector_size_ = 0;
+    uint32_t counted_values_ = 0;
+    bool is_positional_ = false;
+    bool is_parametr_parsed = false;
+    bool is_given_ = false;
+    bool is_optional_ = false;
+    bool is_multi_value_ = false;
+    bool is_lazy_ = false;
+    bool is_non_finite_ = false;
 };
+
+// Size budget of the hot per-argument record: two cache lines. The
+// SettingsLayoutTest reports the exact numbers.
+static_assert(sizeof(ArgumentSettings) <= 128, "ArgumentSettings outgrew two cache lines");
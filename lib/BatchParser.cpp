@@ -0,0 +1,316 @@
+#include "BatchParser.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ArgumentParser {
+    namespace {
+        constexpr size_t kChunkLines = 512;
+
+        bool IsReal(ArgumentSettings::Type type) {
+            return type == ArgumentSettings::Type::Double || type == ArgumentSettings::Type::Float;
+        }
+
+        bool IsLong(ArgumentSettings::Type type) {
+            return type == ArgumentSettings::Type::Int64 || type == ArgumentSettings::Type::UInt32;
+        }
+
+        // Calls f with the value arrays of a numeric column type, one per given
+        // column; false for String columns, which keep their values in chars.
+        template <typename F, typename... Columns>
+        bool VisitValues(ArgumentSettings::Type type, F&& f, Columns&... columns) {
+            switch (type) {
+                case ArgumentSettings::Type::Int:
+                    f(columns.ints...);
+                    return true;
+                case ArgumentSettings::Type::Double:
+                case ArgumentSettings::Type::Float:
+                    f(columns.reals...);
+                    return true;
+                case ArgumentSettings::Type::Int64:
+                case ArgumentSettings::Type::UInt32:
+                    f(columns.longs...);
+                    return true;
+                case ArgumentSettings::Type::UInt64:
+                    f(columns.ulongs...);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        template <typename T>
+        std::span<const T> LineValues(const std::vector<T>& values, const std::vector<size_t>& line_offsets, size_t line) {
+            size_t begin = line_offsets[line];
+            return std::span<const T>(values).subspan(begin, line_offsets[line + 1] - begin);
+        }
+    } // namespace
+
+    size_t BatchResult::Size() const {
+        return status_.size();
+    }
+
+    bool BatchResult::IsParsed(size_t line) const {
+        return status_[line] != kFailed;
+    }
+
+    bool BatchResult::IsHelp(size_t line) const {
+        return status_[line] == kHelp;
+    }
+
+    const BatchResult::Column* BatchResult::FindColumn(std::string_view name) const {
+        uint32_t index = names_->Find(name);
+        return index == FlatIndex::kNotFound ? nullptr : &columns_[index];
+    }
+
+    bool BatchResult::GetFlag(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        return column != nullptr && column->type == ArgumentSettings::Type::Flag && column->flags[line];
+    }
+
+    size_t BatchResult::GetValueCount(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr) {
+            return 0;
+        }
+        if (column->type == ArgumentSettings::Type::Flag) {
+            return column->flags[line];
+        }
+        return column->line_offsets[line + 1] - column->line_offsets[line];
+    }
+
+    std::span<const int> BatchResult::GetIntValues(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr || column->type != ArgumentSettings::Type::Int) {
+            return {};
+        }
+        return LineValues(column->ints, column->line_offsets, line);
+    }
+
+    int BatchResult::GetIntValue(std::string_view name, size_t line, size_t ind) const {
+        std::span<const int> values = GetIntValues(name, line);
+        return ind < values.size() ? values[ind] : -1;
+    }
+
+    std::span<const double> BatchResult::GetDoubleValues(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr || !IsReal(column->type)) {
+            return {};
+        }
+        return LineValues(column->reals, column->line_offsets, line);
+    }
+
+    double BatchResult::GetDoubleValue(std::string_view name, size_t line, size_t ind) const {
+        std::span<const double> values = GetDoubleValues(name, line);
+        return ind < values.size() ? values[ind] : -1;
+    }
+
+    std::span<const int64_t> BatchResult::GetInt64Values(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr || !IsLong(column->type)) {
+            return {};
+        }
+        return LineValues(column->longs, column->line_offsets, line);
+    }
+
+    int64_t BatchResult::GetInt64Value(std::string_view name, size_t line, size_t ind) const {
+        std::span<const int64_t> values = GetInt64Values(name, line);
+        return ind < values.size() ? values[ind] : -1;
+    }
+
+    std::span<const uint64_t> BatchResult::GetUInt64Values(std::string_view name, size_t line) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr || column->type != ArgumentSettings::Type::UInt64) {
+            return {};
+        }
+        return LineValues(column->ulongs, column->line_offsets, line);
+    }
+
+    uint64_t BatchResult::GetUInt64Value(std::string_view name, size_t line, size_t ind) const {
+        std::span<const uint64_t> values = GetUInt64Values(name, line);
+        return ind < values.size() ? values[ind] : 0;
+    }
+
+    std::string_view BatchResult::GetStringValue(std::string_view name, size_t line, size_t ind) const {
+        const Column* column = FindColumn(name);
+        if (column == nullptr || column->type != ArgumentSettings::Type::String) {
+            return {};
+        }
+        size_t value = column->line_offsets[line] + ind;
+        if (value >= column->line_offsets[line + 1]) {
+            return {};
+        }
+        size_t begin = column->string_offsets[value];
+        return std::string_view(column->chars).substr(begin, column->string_offsets[value + 1] - begin);
+    }
+
+    // Per-thread parse state: a ParseResult that ignores the schema bindings and
+    // is reset between lines, so values never leak across lines or threads.
+    class BatchParser::Worker {
+    public:
+        explicit Worker(const Schema& schema) : schema_(schema), result_(schema, false) {
+        }
+
+        void ParseLine(const std::vector<std::string>& line, BatchResult& out) {
+            uint8_t status = BatchResult::kFailed;
+            if (schema_.Parse(line, result_)) {
+                status = result_.IsHelp() ? BatchResult::kHelp : BatchResult::kParsed;
+            }
+            out.status_.push_back(status);
+
+            for (size_t i = 0; i < schema_.Size(); ++i) {
+                BatchResult::Column& column = out.columns_[i];
+                const ArgumentSettings& setting = result_.GetSettings(i);
+                if (column.type == ArgumentSettings::Type::Flag) {
+                    column.flags.push_back(status == BatchResult::kParsed && setting.GetBoolValue());
+                    continue;
+                }
+                if (status == BatchResult::kParsed) {
+                    int count = setting.IsMultiValue() ? setting.GetSize() : 1;
+                    for (int k = 0; k < count; ++k) {
+                        AddValue(column, setting, k);
+                    }
+                }
+                size_t value_count = column.string_offsets.size() - 1;
+                VisitValues(column.type, [&](const auto& values) { value_count = values.size(); }, column);
+                column.line_offsets.push_back(value_count);
+            }
+        }
+
+    private:
+        static void AddValue(BatchResult::Column& column, const ArgumentSettings& setting, int k) {
+            switch (column.type) {
+                case ArgumentSettings::Type::Int:
+                    column.ints.push_back(setting.GetIntVal(k));
+                    break;
+                case ArgumentSettings::Type::Double:
+                case ArgumentSettings::Type::Float:
+                    column.reals.push_back(setting.GetDoubleVal(k));
+                    break;
+                case ArgumentSettings::Type::Int64:
+                    column.longs.push_back(setting.GetValueRef<int64_t>(k));
+                    break;
+                case ArgumentSettings::Type::UInt32:
+                    column.longs.push_back(setting.GetValueRef<uint32_t>(k));
+                    break;
+                case ArgumentSettings::Type::UInt64:
+                    column.ulongs.push_back(setting.GetValueRef<uint64_t>(k));
+                    break;
+                default:
+                    column.chars.append(setting.GetStringView(k));
+                    column.string_offsets.push_back(column.chars.size());
+                    break;
+            }
+        }
+
+        const Schema& schema_;
+        ParseResult result_;
+    };
+
+    BatchParser::BatchParser(const Schema& schema, size_t thread_count)
+        : schema_(schema), names_(std::make_shared<FlatIndex>()), pool_(thread_count) {
+        names_->Reset(schema.Size());
+        for (size_t i = 0; i < schema.Size(); ++i) {
+            if (schema.GetDefinition(i).GetType() == ArgumentSettings::Type::Custom) {
+                throw std::invalid_argument("BatchParser: argument '" + std::string(schema.GetName(i)) +
+                                            "' has a custom type, which has no result column");
+            }
+            names_->Insert(schema.GetName(i), static_cast<uint32_t>(i));
+        }
+    }
+
+    BatchParser::BatchParser(const ArgParser& parser, size_t thread_count)
+        : BatchParser(parser.GetSchema(), thread_count) {
+    }
+
+    BatchParser::~BatchParser() = default;
+
+    BatchResult BatchParser::MakeEmptyResult() const {
+        BatchResult result;
+        result.names_ = names_;
+        result.columns_.resize(schema_.Size());
+        for (size_t i = 0; i < schema_.Size(); ++i) {
+            result.columns_[i].type = schema_.GetDefinition(i).GetType();
+        }
+        return result;
+    }
+
+    BatchResult BatchParser::Parse(std::span<const std::vector<std::string>> lines) {
+        while (workers_.size() < pool_.Size()) {
+            workers_.push_back(std::make_unique<Worker>(schema_));
+        }
+        size_t chunk_count = (lines.size() + kChunkLines - 1) / kChunkLines;
+        std::vector<BatchResult> chunks(chunk_count, MakeEmptyResult());
+        pool_.ParallelFor(chunk_count, [&](size_t chunk, size_t worker) {
+            size_t end = std::min(lines.size(), (chunk + 1) * kChunkLines);
+            for (size_t line = chunk * kChunkLines; line < end; ++line) {
+                workers_[worker]->ParseLine(lines[line], chunks[chunk]);
+            }
+        });
+        return Merge(chunks);
+    }
+
+    BatchResult BatchParser::Merge(std::vector<BatchResult>& chunks) {
+        BatchResult result = MakeEmptyResult();
+        // where every chunk starts in the merged arrays
+        std::vector<size_t> line_base(chunks.size() + 1, 0);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            line_base[c + 1] = line_base[c] + chunks[c].Size();
+        }
+        size_t column_count = result.columns_.size();
+        std::vector<size_t> value_base((chunks.size() + 1) * column_count, 0);
+        std::vector<size_t> char_base((chunks.size() + 1) * column_count, 0);
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            for (size_t i = 0; i < column_count; ++i) {
+                const BatchResult::Column& column = chunks[c].columns_[i];
+                value_base[(c + 1) * column_count + i] = value_base[c * column_count + i] + column.line_offsets.back();
+                char_base[(c + 1) * column_count + i] = char_base[c * column_count + i] + column.chars.size();
+            }
+        }
+
+        size_t line_count = line_base.back();
+        result.status_.resize(line_count);
+        for (size_t i = 0; i < column_count; ++i) {
+            BatchResult::Column& column = result.columns_[i];
+            size_t value_count = value_base[chunks.size() * column_count + i];
+            if (column.type == ArgumentSettings::Type::Flag) {
+                column.flags.resize(line_count);
+                continue;
+            }
+            column.line_offsets.resize(line_count + 1);
+            if (!VisitValues(column.type, [&](auto& values) { values.resize(value_count); }, column)) {
+                column.string_offsets.resize(value_count + 1);
+                column.chars.resize(char_base[chunks.size() * column_count + i]);
+            }
+        }
+
+        pool_.ParallelFor(chunks.size(), [&](size_t c, size_t) {
+            const BatchResult& chunk = chunks[c];
+            std::copy(chunk.status_.begin(), chunk.status_.end(), result.status_.begin() + line_base[c]);
+            for (size_t i = 0; i < column_count; ++i) {
+                const BatchResult::Column& from = chunk.columns_[i];
+                BatchResult::Column& to = result.columns_[i];
+                if (to.type == ArgumentSettings::Type::Flag) {
+                    std::copy(from.flags.begin(), from.flags.end(), to.flags.begin() + line_base[c]);
+                    continue;
+                }
+                size_t values = value_base[c * column_count + i];
+                for (size_t line = 0; line < chunk.Size(); ++line) {
+                    to.line_offsets[line_base[c] + line + 1] = values + from.line_offsets[line + 1];
+                }
+                auto copy_values = [&](const auto& from_values, auto& to_values) {
+                    std::copy(from_values.begin(), from_values.end(), to_values.begin() + values);
+                };
+                if (!VisitValues(to.type, copy_values, from, to)) {
+                    size_t chars = char_base[c * column_count + i];
+                    for (size_t j = 1; j < from.string_offsets.size(); ++j) {
+                        to.string_offsets[values + j] = chars + from.string_offsets[j];
+                    }
+                    std::memcpy(to.chars.data() + chars, from.chars.data(), from.chars.size());
+                }
+            }
+        });
+        return result;
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ArgParser.h"
+#include "ArgSettings.h"
+#include "FlatIndex.h"
+#include "Schema.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Parse results of a whole batch, stored column by column: every argument
+    // owns one array of values for all lines plus per-line offsets into it.
+    class BatchResult {
+    public:
+        size_t Size() const;
+        bool IsParsed(size_t line) const;
+        bool IsHelp(size_t line) const;
+
+        bool GetFlag(std::string_view name, size_t line) const;
+        size_t GetValueCount(std::string_view name, size_t line) const;
+        std::span<const int> GetIntValues(std::string_view name, size_t line) const;
+        int GetIntValue(std::string_view name, size_t line, size_t ind = 0) const;
+        // Double and Float arguments; Float values are widened.
+        std::span<const double> GetDoubleValues(std::string_view name, size_t line) const;
+        double GetDoubleValue(std::string_view name, size_t line, size_t ind = 0) const;
+        // int64_t and uint32_t arguments; uint32_t values are widened.
+        std::span<const int64_t> GetInt64Values(std::string_view name, size_t line) const;
+        int64_t GetInt64Value(std::string_view name, size_t line, size_t ind = 0) const;
+        std::span<const uint64_t> GetUInt64Values(std::string_view name, size_t line) const;
+        uint64_t GetUInt64Value(std::string_view name, size_t line, size_t ind = 0) const;
+        std::string_view GetStringValue(std::string_view name, size_t line, size_t ind = 0) const;
+
+    private:
+        friend class BatchParser;
+
+        enum LineStatus : uint8_t {
+            kFailed,
+            kParsed,
+            kHelp
+        };
+
+        struct Column {
+            ArgumentSettings::Type type = ArgumentSettings::Type::Flag;
+            std::vector<size_t> line_offsets{0}; // values of line i are [line_offsets[i], line_offsets[i + 1])
+            std::vector<uint8_t> flags;          // Flag: one entry per line
+            std::vector<int> ints;               // Int: one entry per value
+            std::vector<double> reals;           // Double and Float: one entry per value
+            std::vector<int64_t> longs;          // Int64 and UInt32: one entry per value
+            std::vector<uint64_t> ulongs;        // UInt64: one entry per value
+            std::vector<size_t> string_offsets{0}; // String: value j is chars[string_offsets[j], string_offsets[j + 1])
+            std::string chars;
+        };
+
+        const Column* FindColumn(std::string_view name) const;
+
+        std::shared_ptr<const FlatIndex> names_;
+        std::vector<uint8_t> status_;
+        std::vector<Column> columns_;
+    };
+
+    // Parses many command lines against one schema on a thread pool. The schema
+    // has to outlive the parser and stay unchanged while it is in use; Parse
+    // never writes to its StoreValue(s) bindings. Results keep input order.
+    // Arguments of custom AddArgument<T> types have no column; constructing a
+    // BatchParser for such a schema throws std::invalid_argument.
+    class BatchParser {
+    public:
+        explicit BatchParser(const Schema& schema, size_t thread_count = 0);
+        explicit BatchParser(const ArgParser& parser, size_t thread_count = 0);
+        ~BatchParser();
+
+        BatchResult Parse(std::span<const std::vector<std::string>> lines);
+
+    private:
+        class Worker;
+
+        BatchResult MakeEmptyResult() const;
+        BatchResult Merge(std::vector<BatchResult>& chunks);
+
+        const Schema& schema_;
+        std::shared_ptr<FlatIndex> names_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        ThreadPool pool_;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,61 @@
+#include "ConfigSource.h"
+
+namespace ArgumentParser {
+    namespace {
+        std::string_view Trim(std::string_view text) {
+            size_t begin = text.find_first_not_of(" \t\r");
+            if (begin == std::string_view::npos) {
+                return {};
+            }
+            size_t end = text.find_last_not_of(" \t\r");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        std::string_view Unquote(std::string_view value) {
+            if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+                return value.substr(1, value.size() - 2);
+            }
+            return value;
+        }
+    } // namespace
+
+    ConfigSource::ConfigSource(const std::string& path) {
+        is_open_ = file_.Open(path);
+        if (is_open_) {
+            BuildIndex();
+        }
+    }
+
+    void ConfigSource::BuildIndex() {
+        std::string_view contents = file_.Contents();
+        while (!contents.empty()) {
+            size_t line_end = contents.find('\n');
+            std::string_view line = Trim(contents.substr(0, line_end));
+            contents.remove_prefix(line_end == std::string_view::npos ? contents.size() : line_end + 1);
+            if (line.empty() || line[0] == '#' || line[0] == ';') {
+                continue;
+            }
+            size_t eq_pos = line.find('=');
+            if (eq_pos == std::string_view::npos) {
+                continue;
+            }
+            std::string_view key = Trim(line.substr(0, eq_pos));
+            if (!key.empty()) {
+                index_[key].push_back(Unquote(Trim(line.substr(eq_pos + 1))));
+            }
+        }
+    }
+
+    std::span<const std::string_view> ConfigSource::Find(std::string_view key) const {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return {};
+        }
+        return it->second;
+    }
+
+    bool ConfigSource::IsOpen() const {
+        return is_open_;
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Values of a configuration file made of "key = value" lines, used as a
+    // fallback for options missing from the command line. The file is mapped
+    // and indexed once when it is opened; keys and values are views into the
+    // mapping, nothing is copied out of it.
+    //
+    // Whitespace around keys and values is trimmed and one pair of enclosing
+    // quotes is stripped from values. Lines that are empty, start with '#' or
+    // ';', or have no '=' are skipped. A key repeated on several lines gives
+    // several values, for multi-value options.
+    class ConfigSource {
+    public:
+        // A file that cannot be read is an empty source.
+        explicit ConfigSource(const std::string& path);
+
+        // Values of key in file order; empty if the key is not in the file.
+        std::span<const std::string_view> Find(std::string_view key) const;
+        bool IsOpen() const;
+
+    private:
+        void BuildIndex();
+
+        MappedFile file_;
+        bool is_open_ = false;
+        std::unordered_map<std::string_view, std::vector<std::string_view>> index_;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace ArgumentParser {
+
+    namespace detail {
+
+        constexpr uint64_t kAsciiZeros = 0x3030303030303030ull;
+
+        // SWAR check that all 8 bytes are in '0'..'9'.
+        inline bool IsEightDigits(uint64_t chunk) {
+            return ((chunk & 0xF0F0F0F0F0F0F0F0ull) |
+                    (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+        }
+
+        // Converts 8 ASCII digits loaded little-endian into their value with three
+        // multiplications instead of eight dependent multiply-adds.
+        inline uint64_t ParseEightDigits(uint64_t chunk) {
+            chunk -= kAsciiZeros;
+            chunk = (chunk * 10) + (chunk >> 8);
+            chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                     (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+            return chunk;
+        }
+
+        // Parses up to 16 decimal digits; returns false on any non-digit.
+        inline bool ParseShortDigits(std::string_view digits, uint64_t& result) {
+            uint64_t acc = 0;
+            const char* ptr = digits.data();
+            size_t left = digits.size();
+            while (left >= 8) {
+                uint64_t chunk;
+                std::memcpy(&chunk, ptr, sizeof(chunk));
+                if (!IsEightDigits(chunk)) {
+                    return false;
+                }
+                acc = acc * 100000000ull + ParseEightDigits(chunk);
+                ptr += 8;
+                left -= 8;
+            }
+            for (; left > 0; --left, ++ptr) {
+                unsigned digit = static_cast<unsigned char>(*ptr) - '0';
+                if (digit > 9) {
+                    return false;
+                }
+                acc = acc * 10 + digit;
+            }
+            result = acc;
+            return true;
+        }
+
+    } // namespace detail
+
+    // Locale-independent, exception-free integer conversion. The whole token has
+    // to be a decimal number with an optional sign; anything else, including
+    // values out of the range of Int, makes it return false and leaves value
+    // untouched.
+    template <typename Int>
+    bool ConvertInteger(std::string_view token, Int& value) {
+        static_assert(std::is_integral_v<Int>);
+        bool is_negative = false;
+        std::string_view digits = token;
+        if (!digits.empty() && (digits[0] == '-' || digits[0] == '+')) {
+            is_negative = (digits[0] == '-');
+            digits.remove_prefix(1);
+        }
+        if (digits.empty() || static_cast<unsigned char>(digits[0] - '0') > 9) {
+            return false;
+        }
+        if constexpr (std::endian::native == std::endian::little && sizeof(Int) <= sizeof(uint64_t)) {
+            uint64_t magnitude = 0;
+            if (digits.size() <= 16 && detail::ParseShortDigits(digits, magnitude)) {
+                if (is_negative) {
+                    if constexpr (std::is_unsigned_v<Int>) {
+                        if (magnitude != 0) {
+                            return false;
+                        }
+                    } else {
+                        using Unsigned = std::make_unsigned_t<Int>;
+                        if (magnitude > static_cast<Unsigned>(std::numeric_limits<Int>::max()) + 1ull) {
+                            return false;
+                        }
+                        value = static_cast<Int>(0 - static_cast<Unsigned>(magnitude));
+                        return true;
+                    }
+                }
+                if (magnitude > static_cast<uint64_t>(std::numeric_limits<Int>::max())) {
+                    return false;
+                }
+                value = static_cast<Int>(magnitude);
+                return true;
+            }
+            if (digits.size() <= 16) {
+                return false;
+            }
+        }
+        // long or exotic input: leave the range checking to from_chars
+        if (!is_negative) {
+            token = digits;
+        }
+        Int result;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), result);
+        if (ec != std::errc() || ptr != token.data() + token.size()) {
+            return false;
+        }
+        value = result;
+        return true;
+    }
+
+    // Floating-point counterpart of ConvertInteger: std::from_chars in general
+    // format, so the result is exactly rounded and independent of the locale.
+    // The whole token has to be consumed; a leading '+' is accepted, and values
+    // outside the range of Real are rejected. So are "inf", "nan" and the like,
+    // unless allow_non_finite is set.
+    template <typename Real>
+    bool ConvertReal(std::string_view token, Real& value, bool allow_non_finite = false) {
+        static_assert(std::is_floating_point_v<Real>);
+        if (token.size() > 1 && token[0] == '+' && token[1] != '-') {
+            token.remove_prefix(1);
+        }
+        Real result;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), result);
+        if (ec != std::errc() || ptr != token.data() + token.size() || (!allow_non_finite && !std::isfinite(result))) {
+            return false;
+        }
+        value = result;
+        return true;
+    }
+
+    // Conversion of one token into a T, picked at compile time for arguments
+    // added with AddArgument<T>. Specialize it for own types; kTypeName, if
+    // present, is shown in the help text:
+    //
+    //     template <>
+    //     struct ArgumentParser::ValueConverter<Bytes> {
+    //         static constexpr std::string_view kTypeName = "bytes";
+    //         static bool Convert(std::string_view token, Bytes& value);
+    //     };
+    //
+    // Convert returns false for tokens that are not a valid T.
+    template <typename T>
+    struct ValueConverter;
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    struct ValueConverter<T> {
+        static constexpr std::string_view kTypeName = "int";
+
+        static bool Convert(std::string_view token, T& value) {
+            return ConvertInteger(token, value);
+        }
+    };
+
+    template <typename T>
+        requires std::is_floating_point_v<T>
+    struct ValueConverter<T> {
+        static constexpr std::string_view kTypeName = std::is_same_v<T, float> ? "float" : "double";
+
+        static bool Convert(std::string_view token, T& value) {
+            return ConvertReal(token, value);
+        }
+    };
+
+} // namespace ArgumentParser
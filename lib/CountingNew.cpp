@@ -0,0 +1,108 @@
+// Replacement global operator new/delete that report to AllocationScope. Link
+// the argparser_alloc_counter object library into a program to enable it.
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Every block starts with a header holding the requested size and the
+    // header length, so delete knows what to subtract and what to free.
+    struct Header {
+        size_t size;
+        size_t offset;
+    };
+
+    void* Allocate(size_t size, size_t alignment) {
+        size_t offset = alignment > sizeof(Header) ? alignment : sizeof(Header);
+        void* raw;
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            size_t total = (size + offset + alignment - 1) / alignment * alignment;
+            raw = std::aligned_alloc(alignment, total);
+        } else {
+            offset = (offset + __STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1) / __STDCPP_DEFAULT_NEW_ALIGNMENT__ * __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+            raw = std::malloc(size + offset);
+        }
+        if (raw == nullptr) {
+            return nullptr;
+        }
+        char* ptr = static_cast<char*>(raw) + offset;
+        reinterpret_cast<Header*>(ptr)[-1] = Header{size, offset};
+        ArgumentParser::detail::RecordAllocation(size);
+        return ptr;
+    }
+
+    void Deallocate(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        Header header = static_cast<Header*>(ptr)[-1];
+        ArgumentParser::detail::RecordDeallocation(header.size);
+        std::free(static_cast<char*>(ptr) - header.offset);
+    }
+
+    void* AllocateOrThrow(size_t size, size_t alignment) {
+        void* ptr = Allocate(size == 0 ? 1 : size, alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    const bool kEnabled = (ArgumentParser::detail::EnableAllocationCounting(), true);
+} // namespace
+
+void* operator new(size_t size) {
+    return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size) {
+    return AllocateOrThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size == 0 ? 1 : size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size == 0 ? 1 : size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
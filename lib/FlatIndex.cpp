@@ -0,0 +1,50 @@
+#include "FlatIndex.h"
+#include <bit>
+#include <functional>
+
+namespace ArgumentParser {
+    namespace {
+        uint32_t HashName(std::string_view name) {
+            size_t hash = std::hash<std::string_view>{}(name);
+            return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+    } // namespace
+
+    void FlatIndex::Reset(size_t count) {
+        Clear();
+        // keep the load factor at or below 1/2 so probe chains stay short
+        slots_.assign(std::bit_ceil(count * 2 + 1), Slot());
+    }
+
+    void FlatIndex::Insert(std::string_view name, uint32_t index) {
+        uint32_t hash = HashName(name);
+        size_t mask = slots_.size() - 1;
+        size_t pos = hash & mask;
+        while (slots_[pos].index != kNotFound) {
+            pos = (pos + 1) & mask;
+        }
+        slots_[pos] = Slot{hash, index, static_cast<uint32_t>(pool_.size()), static_cast<uint32_t>(name.size())};
+        pool_.append(name);
+    }
+
+    uint32_t FlatIndex::Find(std::string_view name) const {
+        if (slots_.empty()) {
+            return kNotFound;
+        }
+        uint32_t hash = HashName(name);
+        size_t mask = slots_.size() - 1;
+        for (size_t pos = hash & mask; slots_[pos].index != kNotFound; pos = (pos + 1) & mask) {
+            const Slot& slot = slots_[pos];
+            if (slot.hash == hash && std::string_view(pool_).substr(slot.name_offset, slot.name_size) == name) {
+                return slot.index;
+            }
+        }
+        return kNotFound;
+    }
+
+    void FlatIndex::Clear() {
+        slots_.clear();
+        pool_.clear();
+    }
+
+} // namespace ArgumentParser
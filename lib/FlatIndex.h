@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Read-only open-addressing table from names to dense indices. Names are
+    // copied into one contiguous pool and every slot keeps a 32-bit hash next
+    // to the name range, so a hit usually touches one slot and one pool range.
+    class FlatIndex {
+    public:
+        static constexpr uint32_t kNotFound = UINT32_MAX;
+
+        void Reset(size_t count);
+        void Insert(std::string_view name, uint32_t index);
+        uint32_t Find(std::string_view name) const;
+        void Clear();
+
+    private:
+        struct Slot {
+            uint32_t hash = 0;
+            uint32_t index = kNotFound;
+            uint32_t name_offset = 0;
+            uint32_t name_size = 0;
+        };
+
+        std::vector<Slot> slots_;
+        std::string pool_;
+    };
+
+} // namespace ArgumentParser
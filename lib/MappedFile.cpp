@@ -0,0 +1,81 @@
+#include "MappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARGPARSER_HAVE_MMAP 1
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace ArgumentParser {
+    MappedFile::~MappedFile() {
+#ifdef ARGPARSER_HAVE_MMAP
+        if (is_mapped_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    bool MappedFile::Open(const std::string& path, bool sequential) {
+#ifdef ARGPARSER_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ > 0) {
+            void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) {
+                close(fd);
+                return false;
+            }
+            if (sequential) {
+                madvise(map, size_, MADV_SEQUENTIAL);
+            }
+            data_ = static_cast<const char*>(map);
+            is_mapped_ = true;
+        }
+        close(fd);
+#else
+        (void)sequential;
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+#endif
+        return true;
+    }
+
+    std::string_view MappedFile::Contents() const {
+        return std::string_view(data_, size_);
+    }
+
+    void MappedFile::Discard(size_t offset) {
+#ifdef ARGPARSER_HAVE_MMAP
+        if (!is_mapped_) {
+            return;
+        }
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t end = offset / page * page;
+        if (end > discarded_) {
+            madvise(const_cast<char*>(data_) + discarded_, end - discarded_, MADV_DONTNEED);
+            discarded_ = end;
+        }
+#else
+        (void)offset;
+#endif
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ArgumentParser {
+
+    // Read-only view of a whole file. The file is memory-mapped where the
+    // platform allows it and read into a buffer otherwise.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        // sequential hints the kernel to read ahead aggressively.
+        bool Open(const std::string& path, bool sequential = false);
+        std::string_view Contents() const;
+        // Hands the pages that lie entirely before offset back to the kernel;
+        // that part of Contents() must not be read again.
+        void Discard(size_t offset);
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        size_t discarded_ = 0;
+        bool is_mapped_ = false;
+        std::string buffer_; // file contents where mmap is unavailable
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,132 @@
+#include "NameTrie.h"
+#include <algorithm>
+
+namespace ArgumentParser {
+    namespace {
+        size_t CommonPrefix(std::string_view a, std::string_view b) {
+            size_t size = std::min(a.size(), b.size());
+            return std::mismatch(a.begin(), a.begin() + size, b.begin()).first - a.begin();
+        }
+    } // namespace
+
+    void NameTrie::Build(Entries entries) {
+        Clear();
+        std::sort(entries.begin(), entries.end());
+        nodes_.emplace_back();
+        Fill(0, entries, 0, entries.size(), 0);
+        labels_.shrink_to_fit();
+    }
+
+    // node stands for the first depth bytes of entries[begin, end).
+    void NameTrie::Fill(uint32_t node, const Entries& entries, size_t begin, size_t end, size_t depth) {
+        nodes_[node].count = static_cast<uint32_t>(end - begin);
+        if (begin == end) {
+            return;
+        }
+        nodes_[node].any = entries[begin].second;
+        if (entries[begin].first.size() == depth) {
+            // sorted, so the name that ends here comes first
+            nodes_[node].index = entries[begin].second;
+            ++begin;
+        }
+        size_t child_count = 0;
+        for (size_t i = begin; i < end; ++child_count) {
+            char ch = entries[i].first[depth];
+            while (i < end && entries[i].first[depth] == ch) {
+                ++i;
+            }
+        }
+        uint32_t first_child = static_cast<uint32_t>(nodes_.size());
+        nodes_[node].first_child = first_child;
+        nodes_[node].child_count = static_cast<uint32_t>(child_count);
+        nodes_.resize(nodes_.size() + child_count);
+
+        uint32_t child = first_child;
+        for (size_t i = begin; i < end; ++child) {
+            size_t group_end = i;
+            char ch = entries[i].first[depth];
+            while (group_end < end && entries[group_end].first[depth] == ch) {
+                ++group_end;
+            }
+            // the group is sorted, so its first and last names bound the common prefix
+            size_t prefix = CommonPrefix(entries[i].first, entries[group_end - 1].first);
+            std::string_view label = entries[i].first.substr(depth, prefix - depth);
+            nodes_[child].label_offset = static_cast<uint32_t>(labels_.size());
+            nodes_[child].label_size = static_cast<uint32_t>(label.size());
+            nodes_[child].first = ch;
+            labels_.append(label);
+            Fill(child, entries, i, group_end, prefix);
+            i = group_end;
+        }
+    }
+
+    NameTrie::Match NameTrie::Find(std::string_view name) const {
+        Match match;
+        if (nodes_.empty()) {
+            return match;
+        }
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < name.size()) {
+            const Node& parent = nodes_[node];
+            uint32_t child = parent.first_child;
+            uint32_t last = parent.first_child + parent.child_count;
+            while (child < last && nodes_[child].first != name[pos]) {
+                ++child;
+            }
+            if (child == last) {
+                match.node = node;
+                match.matched = static_cast<uint32_t>(pos);
+                return match;
+            }
+            const Node& next = nodes_[child];
+            std::string_view label(labels_.data() + next.label_offset, next.label_size);
+            size_t common = CommonPrefix(label, name.substr(pos));
+            pos += common;
+            node = child;
+            if (common < label.size()) {
+                // the name ends or leaves the trie inside this label
+                match.node = node;
+                match.matched = static_cast<uint32_t>(pos);
+                match.is_prefix = pos == name.size();
+                if (match.is_prefix && next.count == 1) {
+                    match.unique = next.any;
+                }
+                return match;
+            }
+        }
+        const Node& last = nodes_[node];
+        match.node = node;
+        match.matched = static_cast<uint32_t>(pos);
+        match.is_prefix = true;
+        match.exact = last.index;
+        if (last.count == 1) {
+            match.unique = last.any;
+        }
+        return match;
+    }
+
+    uint32_t NameTrie::FindExact(std::string_view name) const {
+        Match match = Find(name);
+        return match.exact;
+    }
+
+    void NameTrie::Collect(uint32_t node, std::vector<uint32_t>& out) const {
+        if (node >= nodes_.size()) {
+            return;
+        }
+        const Node& current = nodes_[node];
+        if (current.index != kNotFound) {
+            out.push_back(current.index);
+        }
+        for (uint32_t i = 0; i < current.child_count; ++i) {
+            Collect(current.first_child + i, out);
+        }
+    }
+
+    void NameTrie::Clear() {
+        nodes_.clear();
+        labels_.clear();
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Read-only radix trie from names to dense indices. Nodes sit in one
+    // vector with the children of every node next to each other in byte
+    // order, and the edge labels in one string pool, so a lookup walks the
+    // name once and stops at the first byte that no name continues with.
+    class NameTrie {
+    public:
+        static constexpr uint32_t kNotFound = UINT32_MAX;
+
+        // What one pass over a name found.
+        struct Match {
+            uint32_t exact = kNotFound;  // the name itself
+            uint32_t unique = kNotFound; // the only name that starts with it
+            uint32_t node = 0;           // deepest node the name reached
+            uint32_t matched = 0;        // bytes of the name found in the trie
+            bool is_prefix = false;      // every name below node starts with the name
+        };
+
+        // Names have to be unique.
+        void Build(std::vector<std::pair<std::string_view, uint32_t>> entries);
+        Match Find(std::string_view name) const;
+        uint32_t FindExact(std::string_view name) const;
+        // Indices of all names below node, in byte order of the names.
+        void Collect(uint32_t node, std::vector<uint32_t>& out) const;
+        void Clear();
+
+    private:
+        struct Node {
+            uint32_t label_offset = 0;
+            uint32_t label_size = 0;
+            uint32_t first_child = 0;
+            uint32_t child_count = 0;
+            uint32_t index = kNotFound; // name ending at this node
+            uint32_t any = kNotFound;   // some name below, the only one if count == 1
+            uint32_t count = 0;         // names below, this node's own included
+            char first = '\0';          // label_[0], checked before the pool is read
+        };
+
+        using Entries = std::vector<std::pair<std::string_view, uint32_t>>;
+
+        void Fill(uint32_t node, const Entries& entries, size_t begin, size_t end, size_t depth);
+
+        std::vector<Node> nodes_;
+        std::string labels_;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ArgumentParser {
+
+    // Typed handle of one argument, returned by Schema::Handle<T>: just its
+    // schema index, so reading a ParseResult through it needs no name lookup.
+    template <typename T>
+    class Option {
+    public:
+        // What ParseResult::Get returns: flags give bool and strings a view,
+        // every other type a reference into the result.
+        using Value = std::conditional_t<std::is_same_v<T, bool>, bool,
+            std::conditional_t<std::is_same_v<T, std::string>, std::string_view, const T&>>;
+
+        Option() = default;
+
+        explicit Option(size_t index) : index_(index) {
+        }
+
+        size_t Index() const {
+            return index_;
+        }
+
+        bool IsValid() const {
+            return index_ != SIZE_MAX;
+        }
+
+    private:
+        size_t index_ = SIZE_MAX;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,306 @@
+#pragma once
+
+#include "ArgSettings.h"
+#include "Convert.h"
+#include "ParseError.h"
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+
+namespace ArgumentParser {
+
+    std::string_view DefineArgumentName(std::string_view argument);
+
+    // What an optional Lookup::MatchArgument found for a long name.
+    struct ArgumentMatch {
+        ArgumentSettings* setting = nullptr;
+        bool is_ambiguous = false; // abbreviates several arguments
+    };
+
+    // Token state machine shared by the parser front ends. Lookup has to provide
+    // FindArgument(std::string_view) and FindShortArgument(char), both returning
+    // ArgumentSettings* (nullptr for unknown names). An optional
+    // MatchArgument(std::string_view) returning ArgumentMatch replaces
+    // FindArgument for long names and tells apart names that abbreviate
+    // several arguments.
+    //
+    // With count_only set the engine walks the tokens the same way but only
+    // calls CountValue on the settings that would receive a value, so a caller
+    // can reserve exact capacity before the real pass.
+    //
+    // If Lookup also has ReportError(const ParseError&, const ArgumentSettings*)
+    // every failure is passed to it, located in the token last given to
+    // SetToken. Reporting builds no strings and never throws. An optional
+    // CompleteArgument(const ArgumentSettings&) hears of every argument that
+    // will get no more values from the current occurrence.
+    template <typename Lookup>
+    class ParseEngine {
+    public:
+        ParseEngine(Lookup& lookup, ArgumentSettings* positional, ArgumentSettings* help, bool count_only = false)
+            : lookup_(lookup), positional_(positional), help_(help), count_only_(count_only) {
+        }
+
+        // Command-line token index and text of the tokens processed next; tokens
+        // read from a response file are reported at the "@file" token.
+        void SetToken(size_t index, std::string_view token) {
+            token_index_ = static_cast<uint32_t>(index);
+            origin_ = token;
+        }
+
+        void ProcessToken(std::string_view token) {
+            token_ = token;
+            if (token.empty() || token[0] != '-') {
+                if (pending_ == nullptr) {
+                    ProcessPositionalArgument(token);
+                    return;
+                }
+                AddTokenValue(*pending_, token);
+                pending_has_values_ = true;
+                if (!pending_->IsMultiValue()) {
+                    Complete(*pending_);
+                    pending_ = nullptr;
+                }
+                return;
+            }
+            ClosePendingArgument();
+            if (token.size() > 1 && token[1] == '-') {
+                ProcessLongArg(token);
+            } else {
+                ProcessShortArg(token);
+            }
+        }
+
+        // Returns false if some token could not be matched to an argument.
+        bool Finish() {
+            ClosePendingArgument();
+            if (positional_ != nullptr && positional_->IsMultiValue() && positional_->IsGiven() && !is_finished_) {
+                Complete(*positional_);
+            }
+            is_finished_ = true;
+            return is_parsed_;
+        }
+
+        bool IsHelp() const {
+            return is_help_;
+        }
+
+        // An option was just opened and the next token has to be its value.
+        bool IsAwaitingValue() const {
+            return pending_ != nullptr && !pending_has_values_;
+        }
+
+        // The argument the next plain tokens go to, if it is a numeric
+        // multi-value argument (see ArgumentSettings::IsNumeric) and those
+        // tokens may be converted in bulk by the caller (see AcceptBulkValues);
+        // nullptr otherwise.
+        ArgumentSettings* BulkValueTarget() const {
+            ArgumentSettings* target = pending_ != nullptr ? pending_ : positional_;
+            if (count_only_ || target == nullptr || !target->IsMultiValue() || target->IsLazy()) {
+                return nullptr;
+            }
+            return target->IsNumeric() ? target : nullptr;
+        }
+
+        // The caller stored values for BulkValueTarget() itself.
+        void AcceptBulkValues() {
+            if (pending_ != nullptr) {
+                pending_has_values_ = true;
+            } else {
+                positional_->SetParameterParsed();
+            }
+        }
+
+        // A value from outside the command line, e.g. an environment variable.
+        // Flags take true/false, yes/no, on/off or 1/0.
+        void SupplyValue(ArgumentSettings& setting, std::string_view value) {
+            token_index_ = ParseError::kNone;
+            setting.SetParameterParsed();
+            if (setting.GetType() != ArgumentSettings::Type::Flag) {
+                AddTokenValue(setting, value);
+                return;
+            }
+            if (value == "1" || value == "true" || value == "yes" || value == "on") {
+                setting.AddValue(true);
+            } else if (value == "0" || value == "false" || value == "no" || value == "off") {
+                setting.AddValue(false);
+            } else {
+                Report(ParseErrorCode::InvalidValue, Locate(value), &setting);
+            }
+        }
+
+        // For errors found outside the engine, e.g. an unreadable response file.
+        // They are located at the whole current command-line token.
+        void Fail(ParseErrorCode code = ParseErrorCode::ResponseFile) {
+            token_ = origin_;
+            Report(code, Locate(origin_), nullptr);
+        }
+
+    private:
+        void AddTokenValue(ArgumentSettings& setting, std::string_view value) {
+            if (count_only_) {
+                setting.CountValue();
+            } else if (setting.IsLazy()) {
+                setting.AddLazyValue(value);
+            } else if (!setting.AddTokenValue(value)) {
+                Report(ParseErrorCode::InvalidValue, Locate(value), &setting);
+            }
+        }
+
+        // Position of part, a piece of the token being processed.
+        ParseError Locate(std::string_view part) const {
+            ParseError location;
+            location.token = token_index_;
+            if (token_index_ == ParseError::kNone) {
+                return location;
+            }
+            if (token_.data() != origin_.data()) {
+                // a response file token
+                location.length = static_cast<uint32_t>(origin_.size());
+                return location;
+            }
+            location.offset = static_cast<uint32_t>(part.data() - token_.data());
+            location.length = static_cast<uint32_t>(part.size());
+            return location;
+        }
+
+        void Report(ParseErrorCode code, ParseError location, const ArgumentSettings* setting) {
+            is_parsed_ = false;
+            if constexpr (requires { lookup_.ReportError(location, setting); }) {
+                if (!count_only_) {
+                    location.code = code;
+                    lookup_.ReportError(location, setting);
+                }
+            }
+        }
+
+        void Complete(const ArgumentSettings& setting) {
+            if constexpr (requires { lookup_.CompleteArgument(setting); }) {
+                if (!count_only_) {
+                    lookup_.CompleteArgument(setting);
+                }
+            }
+        }
+
+        void ClosePendingArgument() {
+            if (pending_ != nullptr && !pending_has_values_) {
+                Report(ParseErrorCode::MissingValue, pending_location_, pending_);
+            } else if (pending_ != nullptr) {
+                Complete(*pending_);
+            }
+            pending_ = nullptr;
+        }
+
+        // Marks the argument as seen; returns true if it still expects a value.
+        bool OpenArgument(ArgumentSettings& setting) {
+            if (!count_only_) {
+                setting.SetParameterParsed();
+            }
+            if (&setting == help_) {
+                is_help_ = true;
+                return false;
+            }
+            if (setting.GetType() == ArgumentSettings::Type::Flag) {
+                if (!count_only_) {
+                    setting.AddValue(true);
+                }
+                Complete(setting);
+                return false;
+            }
+            return true;
+        }
+
+        // name: the option's name in the current token
+        void ExpectValues(ArgumentSettings& setting, std::string_view name) {
+            pending_ = &setting;
+            pending_location_ = Locate(name);
+            pending_has_values_ = false;
+        }
+
+        void ProcessLongArg(std::string_view token) {
+            std::string_view name = DefineArgumentName(token);
+            ArgumentMatch match;
+            if constexpr (requires { { lookup_.MatchArgument(name) } -> std::same_as<ArgumentMatch>; }) {
+                match = lookup_.MatchArgument(name);
+            } else {
+                match.setting = lookup_.FindArgument(name);
+            }
+            ArgumentSettings* setting = match.setting;
+            if (setting == nullptr) {
+                ParseErrorCode code = match.is_ambiguous ? ParseErrorCode::AmbiguousOption
+                                                         : ParseErrorCode::UnknownOption;
+                Report(code, Locate(name), nullptr);
+                return;
+            }
+            if (!OpenArgument(*setting)) {
+                return;
+            }
+            size_t eq_pos = token.find('=');
+            if (eq_pos != std::string_view::npos) {
+                AddTokenValue(*setting, token.substr(eq_pos + 1));
+                Complete(*setting);
+            } else {
+                ExpectValues(*setting, name);
+            }
+        }
+
+        // POSIX-style clusters: every character is a short option until one that
+        // takes a value, which then gets the rest of the token ("-abn5", "-ofile",
+        // "-p=value") or the following tokens if nothing is left.
+        void ProcessShortArg(std::string_view token) {
+            if (token.size() == 1) {
+                Report(ParseErrorCode::UnknownOption, Locate(token), nullptr);
+                return;
+            }
+            for (size_t j = 1; j < token.size(); ++j) {
+                ArgumentSettings* setting = lookup_.FindShortArgument(token[j]);
+                if (setting == nullptr) {
+                    Report(ParseErrorCode::UnknownOption, Locate(token.substr(j, 1)), nullptr);
+                    return;
+                }
+                if (!OpenArgument(*setting)) {
+                    if (is_help_) {
+                        return;
+                    }
+                    continue;
+                }
+                std::string_view rest = token.substr(j + 1);
+                if (rest.empty()) {
+                    ExpectValues(*setting, token.substr(j, 1));
+                } else {
+                    AddTokenValue(*setting, rest[0] == '=' ? rest.substr(1) : rest);
+                    Complete(*setting);
+                }
+                return;
+            }
+        }
+
+        void ProcessPositionalArgument(std::string_view token) {
+            if (positional_ == nullptr) {
+                Report(ParseErrorCode::UnexpectedPositional, Locate(token), nullptr);
+                return;
+            }
+            if (!count_only_) {
+                positional_->SetParameterParsed();
+            }
+            AddTokenValue(*positional_, token);
+            if (!positional_->IsMultiValue()) {
+                Complete(*positional_);
+            }
+        }
+
+        Lookup& lookup_;
+        ArgumentSettings* positional_;
+        ArgumentSettings* help_;
+        ArgumentSettings* pending_ = nullptr; // option still waiting for its values
+        ParseError pending_location_;          // where pending_ was named
+        std::string_view token_;               // token being processed
+        std::string_view origin_;              // command-line token it came from
+        uint32_t token_index_ = ParseError::kNone;
+        bool pending_has_values_ = false;
+        bool is_parsed_ = true;
+        bool is_help_ = false;
+        bool is_finished_ = false;
+        bool count_only_;
+    };
+
+} // namespace ArgumentParser
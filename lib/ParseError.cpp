@@ -0,0 +1,26 @@
+#include "ParseError.h"
+
+namespace ArgumentParser {
+    std::string_view ToString(ParseErrorCode code) {
+        switch (code) {
+            case ParseErrorCode::UnknownOption:
+                return "unknown option";
+            case ParseErrorCode::AmbiguousOption:
+                return "ambiguous option";
+            case ParseErrorCode::MissingValue:
+                return "missing value";
+            case ParseErrorCode::InvalidValue:
+                return "invalid value";
+            case ParseErrorCode::UnexpectedPositional:
+                return "unexpected positional argument";
+            case ParseErrorCode::MissingArgument:
+                return "missing required argument";
+            case ParseErrorCode::TooFewValues:
+                return "too few values";
+            case ParseErrorCode::ResponseFile:
+                return "bad response file";
+        }
+        return "parse error";
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace ArgumentParser {
+
+    enum class ParseErrorCode : uint8_t {
+        UnknownOption,        // no argument with this name
+        AmbiguousOption,      // abbreviation of several long names
+        MissingValue,         // option at the end of its values without any
+        InvalidValue,         // value that does not convert to the argument's type
+        UnexpectedPositional, // plain token and no positional argument
+        MissingArgument,      // required argument not given
+        TooFewValues,         // fewer values than MultiValue(minimum)
+        ResponseFile,         // unreadable, malformed or too deeply nested "@file"
+    };
+
+    std::string_view ToString(ParseErrorCode code);
+
+    // One failure of a parse, without any text: the culprit is
+    // tokens[token].substr(offset, length) of the parsed command line, where
+    // token 0 is the program name. Errors of values from Env or ConfigFile and
+    // of missing arguments have token == kNone.
+    struct ParseError {
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        ParseErrorCode code = ParseErrorCode::UnknownOption;
+        uint32_t token = kNone;
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t argument = kNone; // schema index of the argument concerned
+    };
+
+} // namespace ArgumentParser
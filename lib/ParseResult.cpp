@@ -0,0 +1,347 @@
+#include "ParseResult.h"
+#include "Schema.h"
+#include <algorithm>
+
+namespace ArgumentParser {
+    ParseResult::ParseResult(const Schema& schema, bool keep_bindings) : keep_bindings_(keep_bindings) {
+        Reset(schema);
+    }
+
+    ParseResult::ParseResult(const Schema& schema, std::pmr::memory_resource* resource, bool keep_bindings)
+        : keep_bindings_(keep_bindings), resource_(resource) {
+        Reset(schema);
+    }
+
+    ParseResult& ParseResult::operator=(ParseResult&& other) noexcept {
+        // the old values have to go before the arena they were allocated from
+        values_ = std::move(other.values_);
+        arena_ = std::move(other.arena_);
+        resource_ = other.resource_;
+        schema_ = other.schema_;
+        schema_version_ = other.schema_version_;
+        keep_bindings_ = other.keep_bindings_;
+        is_parsed_ = other.is_parsed_;
+        is_help_ = other.is_help_;
+        subcommand_ = other.subcommand_;
+        subcommand_result_ = std::move(other.subcommand_result_);
+        token_base_ = other.token_base_;
+        on_complete_ = std::move(other.on_complete_);
+        error_count_ = other.error_count_;
+        errors_ = other.errors_;
+        return *this;
+    }
+
+    std::pmr::memory_resource* ParseResult::Resource() {
+        if (resource_ != nullptr) {
+            return resource_;
+        }
+        if (arena_ == nullptr) {
+            arena_ = std::make_unique<Arena>();
+        }
+        return arena_.get();
+    }
+
+    void ParseResult::Reset(const Schema& schema) {
+        is_parsed_ = false;
+        is_help_ = false;
+        subcommand_ = Schema::kNoArgument;
+        error_count_ = 0;
+        if (schema_ == &schema && schema_version_ == schema.GetVersion()) {
+            for (ArgumentSettings& setting : values_) {
+                setting.ResetValues(arena_ != nullptr);
+            }
+            if (arena_ != nullptr) {
+                arena_->Reset();
+            }
+            return;
+        }
+        schema_ = &schema;
+        schema_version_ = schema.GetVersion();
+        values_.clear();
+        if (arena_ != nullptr) {
+            arena_->Reset();
+        }
+        values_.reserve(schema.Size());
+        for (size_t i = 0; i < schema.Size(); ++i) {
+            values_.push_back(schema.GetDefinition(i).CloneDefinition(keep_bindings_, Resource()));
+        }
+    }
+
+    ParseEngine<ParseResult> ParseResult::MakeEngine(bool count_only) {
+        ArgumentSettings* help = nullptr;
+        ArgumentSettings* positional = nullptr;
+        if (schema_->GetHelpIndex() != Schema::kNoArgument) {
+            help = &values_[schema_->GetHelpIndex()];
+        }
+        if (schema_->GetPositionalIndex() != Schema::kNoArgument) {
+            positional = &values_[schema_->GetPositionalIndex()];
+        }
+        return ParseEngine<ParseResult>(*this, positional, help, count_only);
+    }
+
+    void ParseResult::ReserveCounted() {
+        for (ArgumentSettings& setting : values_) {
+            setting.ReserveCounted();
+        }
+    }
+
+    bool ParseResult::Finish(ParseEngine<ParseResult>& engine) {
+        if (engine.IsHelp()) {
+            is_help_ = true;
+            is_parsed_ = true;
+            error_count_ = 0;
+            return true;
+        }
+        bool is_parsed = engine.Finish();
+        if (schema_->HasFallbacks()) {
+            ApplyFallbacks(engine);
+            is_parsed &= engine.Finish();
+        }
+        for (const ArgumentSettings& setting : values_) {
+            if (!setting.IsParamParsed()) {
+                ReportError(ParseError{.code = ParseErrorCode::MissingArgument}, &setting);
+                is_parsed = false;
+            } else if (setting.IsMultiValue() && static_cast<size_t>(setting.GetSize()) < setting.GetMinCount()) {
+                ReportError(ParseError{.code = ParseErrorCode::TooFewValues}, &setting);
+                is_parsed = false;
+            }
+        }
+
+        is_parsed_ = is_parsed;
+        return is_parsed;
+    }
+
+    ParseResult& ParseResult::StartSubcommand(size_t index, size_t begin) {
+        subcommand_ = index;
+        if (subcommand_result_ == nullptr) {
+            subcommand_result_ = std::make_unique<ParseResult>();
+        }
+        subcommand_result_->token_base_ = token_base_ + static_cast<uint32_t>(begin);
+        subcommand_result_->keep_bindings_ = keep_bindings_;
+        subcommand_result_->resource_ = resource_;
+        return *subcommand_result_;
+    }
+
+    bool ParseResult::FinishSubcommand() {
+        is_help_ = subcommand_result_->is_help_;
+        is_parsed_ = is_help_ || (is_parsed_ && subcommand_result_->is_parsed_);
+        if (is_help_) {
+            error_count_ = 0;
+            return is_parsed_;
+        }
+        for (ParseError error : subcommand_result_->GetErrors()) {
+            error.argument = ParseError::kNone;
+            AddError(error);
+        }
+        // errors that did not fit the subcommand's buffer still count
+        error_count_ += subcommand_result_->error_count_ - subcommand_result_->GetErrors().size();
+        return is_parsed_;
+    }
+
+    void ParseResult::ReportError(ParseError error, const ArgumentSettings* setting) {
+        if (error.token != ParseError::kNone) {
+            error.token += token_base_;
+        }
+        if (setting != nullptr) {
+            error.argument = static_cast<uint32_t>(setting - values_.data());
+        }
+        AddError(error);
+    }
+
+    void ParseResult::CompleteArgument(const ArgumentSettings& setting) {
+        if (on_complete_) {
+            on_complete_(*this, static_cast<size_t>(&setting - values_.data()));
+        }
+    }
+
+    void ParseResult::AddError(const ParseError& error) {
+        if (error_count_ < kMaxErrors) {
+            errors_[error_count_] = error;
+        }
+        ++error_count_;
+    }
+
+    void ParseResult::ApplyFallbacks(ParseEngine<ParseResult>& engine) {
+        for (size_t i = 0; i < values_.size(); ++i) {
+            ArgumentSettings& setting = values_[i];
+            if (setting.IsGiven() || i == schema_->GetHelpIndex()) {
+                continue;
+            }
+            if (const char* env = schema_->FindEnvValue(i)) {
+                std::string_view text = env;
+                if (!setting.IsMultiValue()) {
+                    engine.SupplyValue(setting, text);
+                    continue;
+                }
+                while (!text.empty()) {
+                    size_t begin = text.find_first_not_of(" \t\n");
+                    if (begin == std::string_view::npos) {
+                        break;
+                    }
+                    text.remove_prefix(begin);
+                    size_t end = std::min(text.find_first_of(" \t\n"), text.size());
+                    engine.SupplyValue(setting, text.substr(0, end));
+                    text.remove_prefix(end);
+                }
+                continue;
+            }
+            std::span<const std::string_view> values = schema_->FindConfigValues(i);
+            if (!setting.IsMultiValue() && values.size() > 1) {
+                values = values.last(1); // later lines override earlier ones
+            }
+            for (std::string_view value : values) {
+                engine.SupplyValue(setting, value);
+            }
+        }
+    }
+
+    ArgumentSettings* ParseResult::FindArgument(std::string_view name) {
+        return MatchArgument(name).setting;
+    }
+
+    ArgumentMatch ParseResult::MatchArgument(std::string_view name) {
+        Schema::OptionMatch match = schema_->MatchOption(name);
+        ArgumentMatch result;
+        result.setting = match.index == Schema::kNoArgument ? nullptr : &values_[match.index];
+        result.is_ambiguous = match.is_ambiguous;
+        return result;
+    }
+
+    ArgumentSettings* ParseResult::FindShortArgument(char ch) {
+        size_t index = schema_->FindShortIndex(ch);
+        return index == Schema::kNoArgument ? nullptr : &values_[index];
+    }
+
+    const ArgumentSettings* ParseResult::Find(std::string_view name) const {
+        if (schema_ == nullptr) {
+            return nullptr;
+        }
+        size_t index = schema_->FindIndex(name);
+        return index < values_.size() ? &values_[index] : nullptr;
+    }
+
+    const ArgumentSettings* ParseResult::FindShort(char ch) const {
+        if (schema_ == nullptr) {
+            return nullptr;
+        }
+        size_t index = schema_->FindShortIndex(ch);
+        return index < values_.size() ? &values_[index] : nullptr;
+    }
+
+    bool ParseResult::IsParsed() const {
+        return is_parsed_;
+    }
+
+    bool ParseResult::IsHelp() const {
+        return is_help_;
+    }
+
+    ParseResult::operator bool() const {
+        return is_parsed_;
+    }
+
+    std::span<const ParseError> ParseResult::GetErrors() const {
+        return std::span(errors_).first(std::min<size_t>(error_count_, kMaxErrors));
+    }
+
+    size_t ParseResult::ErrorCount() const {
+        return error_count_;
+    }
+
+    std::string_view ParseResult::GetSubcommand() const {
+        return subcommand_ == Schema::kNoArgument ? std::string_view() : schema_->GetSubcommandName(subcommand_);
+    }
+
+    const ParseResult* ParseResult::GetSubcommandResult() const {
+        return subcommand_ == Schema::kNoArgument ? nullptr : subcommand_result_.get();
+    }
+
+    const ArgumentSettings& ParseResult::GetSettings(size_t index) const {
+        return values_[index];
+    }
+
+    bool ParseResult::GetFlag(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        if (setting != nullptr) {
+            return setting->GetBoolValue();
+        }
+        return false;
+    }
+
+    bool ParseResult::GetFlag(char ch) const {
+        const ArgumentSettings* setting = Find(std::string_view(&ch, 1));
+        if (setting == nullptr) {
+            setting = FindShort(ch);
+        }
+        if (setting != nullptr) {
+            return setting->GetBoolValue();
+        }
+        return false;
+    }
+
+    int ParseResult::GetFlagCount(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        if (setting != nullptr) {
+            return setting->GetFlagCount();
+        }
+        return 0;
+    }
+
+    int ParseResult::GetFlagCount(char ch) const {
+        const ArgumentSettings* setting = FindShort(ch);
+        if (setting != nullptr) {
+            return setting->GetFlagCount();
+        }
+        return 0;
+    }
+
+    int ParseResult::GetIntValue(std::string_view name, int ind) const {
+        const ArgumentSettings* setting = Find(name);
+        if (setting != nullptr) {
+            return setting->GetIntVal(ind);
+        }
+        return -1;
+    }
+
+    std::string ParseResult::GetStringValue(std::string_view name, int ind) const {
+        const ArgumentSettings* setting = Find(!name.empty() && name[0] == '-' ? DefineArgumentName(name) : name);
+        if (setting != nullptr) {
+            return setting->GetStringVal(ind);
+        }
+        return "";
+    }
+
+    double ParseResult::GetDoubleValue(std::string_view name, int ind) const {
+        const ArgumentSettings* setting = Find(name);
+        if (setting != nullptr) {
+            return setting->GetDoubleVal(ind);
+        }
+        return -1;
+    }
+
+    std::span<const int> ParseResult::GetIntValues(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        return setting != nullptr ? setting->GetIntValues() : std::span<const int>();
+    }
+
+    ArgumentSettings::StringRange ParseResult::GetStringValues(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        return setting != nullptr ? setting->GetStringValues() : ArgumentSettings::StringRange();
+    }
+
+    std::span<const double> ParseResult::GetDoubleValues(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        return setting != nullptr ? setting->GetDoubleValues() : std::span<const double>();
+    }
+
+    std::span<const float> ParseResult::GetFloatValues(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        return setting != nullptr ? setting->GetFloatValues() : std::span<const float>();
+    }
+
+    ArgumentSettings::LazyIntRange ParseResult::GetLazyIntValues(std::string_view name) const {
+        const ArgumentSettings* setting = Find(name);
+        return setting != nullptr ? setting->GetLazyIntValues() : ArgumentSettings::LazyIntRange();
+    }
+
+} // namespace ArgumentParser
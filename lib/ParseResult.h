@@ -0,0 +1,205 @@
+#pragma once
+
+#include "Arena.h"
+#include "ArgSettings.h"
+#include "Option.h"
+#include "ParseEngine.h"
+#include "ParseError.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ArgumentParser {
+
+    class Schema;
+    class StreamParser;
+
+    // Values of one Parse call. Refers to the Schema it came from, which has to
+    // outlive it. Parsed strings and value lists live in a private Arena that
+    // is reset by the next parse, so a reused result does not touch the global
+    // allocator once it has warmed up.
+    class ParseResult {
+    public:
+        static constexpr size_t kMaxErrors = 8;
+
+        ParseResult() = default;
+        // keep_bindings = false parses into internal storage only, ignoring the
+        // StoreValue(s) bindings of the schema.
+        explicit ParseResult(const Schema& schema, bool keep_bindings = true);
+        // Allocates values from resource instead of the built-in arena. The
+        // resource has to outlive the result; memory is returned to it through
+        // ordinary deallocation, so a monotonic resource may only be released
+        // after the result is destroyed.
+        ParseResult(const Schema& schema, std::pmr::memory_resource* resource, bool keep_bindings = true);
+
+        ParseResult(ParseResult&& other) noexcept = default;
+        ParseResult& operator=(ParseResult&& other) noexcept;
+
+        bool IsParsed() const;
+        bool IsHelp() const;
+        explicit operator bool() const;
+
+        // The first kMaxErrors failures of the last parse, in the order they
+        // were found. Errors of a subcommand are listed here too, with
+        // argument == ParseError::kNone; its own result has them with the
+        // argument indices of the subcommand's schema.
+        std::span<const ParseError> GetErrors() const;
+        // All failures, including those past the buffer.
+        size_t ErrorCount() const;
+
+        bool GetFlag(std::string_view name) const;
+        bool GetFlag(char ch) const;
+        int GetFlagCount(std::string_view name) const;
+        int GetFlagCount(char ch) const;
+        int GetIntValue(std::string_view name, int ind = 0) const;
+        std::string GetStringValue(std::string_view name, int ind = 0) const;
+        // For Double and Float arguments.
+        double GetDoubleValue(std::string_view name, int ind = 0) const;
+
+        // Views over all values of an argument, valid until the next parse into
+        // this result. Unknown names give empty ranges.
+        std::span<const int> GetIntValues(std::string_view name) const;
+        ArgumentSettings::StringRange GetStringValues(std::string_view name) const;
+        std::span<const double> GetDoubleValues(std::string_view name) const;
+        std::span<const float> GetFloatValues(std::string_view name) const;
+        // For arguments declared Lazy(): converts every value when it is read.
+        ArgumentSettings::LazyIntRange GetLazyIntValues(std::string_view name) const;
+
+        // Value of an argument added as AddArgument<T>; T{} for unknown names.
+        template <typename T>
+        T GetValue(std::string_view name, int ind = 0) const {
+            const ArgumentSettings* setting = Find(name);
+            if (setting == nullptr) {
+                return T{};
+            }
+            if constexpr (std::is_same_v<T, bool>) {
+                return setting->GetBoolValue();
+            } else if constexpr (std::is_same_v<T, int>) {
+                return setting->GetIntVal(ind);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return setting->GetStringVal(ind);
+            } else if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+                return static_cast<T>(setting->GetDoubleVal(ind));
+            } else {
+                const T* value = setting->GetCustomValue<T>(ind);
+                return value != nullptr ? *value : T{};
+            }
+        }
+
+        // All values without copying, like GetIntValues. Strings are read
+        // through GetStringValues.
+        template <typename T>
+        std::span<const T> GetValues(std::string_view name) const {
+            const ArgumentSettings* setting = Find(name);
+            if (setting == nullptr) {
+                return {};
+            }
+            if constexpr (std::is_same_v<T, int>) {
+                return setting->GetIntValues();
+            } else if constexpr (std::is_same_v<T, double>) {
+                return setting->GetDoubleValues();
+            } else if constexpr (std::is_same_v<T, float>) {
+                return setting->GetFloatValues();
+            } else {
+                return setting->GetCustomValues<T>();
+            }
+        }
+
+        // Reads through a handle of this result's schema, without name lookups
+        // or copies; references and views stay valid until the next parse into
+        // this result. Invalid handles give T{}.
+        template <typename T>
+        typename Option<T>::Value Get(Option<T> option, int ind = 0) const {
+            const ArgumentSettings* setting = Find(option);
+            if constexpr (std::is_same_v<T, bool>) {
+                return setting != nullptr && setting->GetBoolValue();
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return setting != nullptr ? setting->GetStringView(ind) : std::string_view();
+            } else {
+                static const T kEmpty{};
+                return setting != nullptr ? setting->GetValueRef<T>(ind) : kEmpty;
+            }
+        }
+
+        // All values of a handle's argument, like GetValues and GetStringValues.
+        template <typename T>
+        auto GetValues(Option<T> option) const {
+            const ArgumentSettings* setting = Find(option);
+            if constexpr (std::is_same_v<T, std::string>) {
+                return setting != nullptr ? setting->GetStringValues() : ArgumentSettings::StringRange();
+            } else if constexpr (std::is_same_v<T, int>) {
+                return setting != nullptr ? setting->GetIntValues() : std::span<const int>();
+            } else if constexpr (std::is_same_v<T, double>) {
+                return setting != nullptr ? setting->GetDoubleValues() : std::span<const double>();
+            } else if constexpr (std::is_same_v<T, float>) {
+                return setting != nullptr ? setting->GetFloatValues() : std::span<const float>();
+            } else {
+                return setting != nullptr ? setting->GetCustomValues<T>() : std::span<const T>();
+            }
+        }
+
+        // Name of the subcommand given on the command line, empty if none was.
+        std::string_view GetSubcommand() const;
+        // Values of the subcommand's own options; nullptr without a subcommand.
+        const ParseResult* GetSubcommandResult() const;
+
+        // Parsed state of the argument with the given schema index.
+        const ArgumentSettings& GetSettings(size_t index) const;
+
+    private:
+        friend class Schema;
+        friend class StreamParser;
+        friend class ParseEngine<ParseResult>;
+
+        void Reset(const Schema& schema);
+        std::pmr::memory_resource* Resource();
+        ParseEngine<ParseResult> MakeEngine(bool count_only = false);
+        void ReserveCounted();
+        bool Finish(ParseEngine<ParseResult>& engine);
+        // begin: position of the subcommand name in the parsed tokens
+        ParseResult& StartSubcommand(size_t index, size_t begin);
+        bool FinishSubcommand();
+        // Env and config values for the options the command line left out.
+        void ApplyFallbacks(ParseEngine<ParseResult>& engine);
+        void ReportError(ParseError error, const ArgumentSettings* setting);
+        void CompleteArgument(const ArgumentSettings& setting);
+        void AddError(const ParseError& error);
+        ArgumentSettings* FindArgument(std::string_view name);
+        ArgumentSettings* FindShortArgument(char ch);
+        ArgumentMatch MatchArgument(std::string_view name);
+        const ArgumentSettings* Find(std::string_view name) const;
+        const ArgumentSettings* FindShort(char ch) const;
+
+        template <typename T>
+        const ArgumentSettings* Find(Option<T> option) const {
+            if (option.Index() >= values_.size()) {
+                return nullptr;
+            }
+            const ArgumentSettings& setting = values_[option.Index()];
+            return setting.Holds<T>() ? &setting : nullptr;
+        }
+
+        const Schema* schema_ = nullptr;
+        uint64_t schema_version_ = 0;
+        bool keep_bindings_ = true;
+        bool is_parsed_ = false;
+        bool is_help_ = false;
+        std::pmr::memory_resource* resource_ = nullptr; // nullptr: use arena_
+        std::unique_ptr<Arena> arena_;                  // declared before values_, which point into it
+        std::vector<ArgumentSettings> values_;
+        size_t subcommand_ = SIZE_MAX; // Schema::kNoArgument if none was given
+        std::unique_ptr<ParseResult> subcommand_result_; // kept for reuse by the next parse
+        uint32_t token_base_ = 0; // index of this result's token 0 in the whole command line
+        std::function<void(const ParseResult&, size_t)> on_complete_; // set while a StreamParser feeds this result
+        uint32_t error_count_ = 0;
+        std::array<ParseError, kMaxErrors> errors_;
+    };
+
+} // namespace ArgumentParser
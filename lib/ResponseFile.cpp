@@ -0,0 +1,107 @@
+#include "ResponseFile.h"
+#include <filesystem>
+
+namespace ArgumentParser {
+    namespace {
+        // how much tokenized text is kept mapped before it is released
+        constexpr size_t kReleaseChunk = size_t{16} << 20;
+
+        bool IsSpace(char ch) {
+            return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+        }
+    } // namespace
+
+    bool ResponseFile::Open(const std::string& path) {
+        if (!file_.Open(path, true)) {
+            return false;
+        }
+        path_ = path;
+        data_ = file_.Contents().data();
+        size_ = file_.Contents().size();
+        is_valid_ = true;
+        return true;
+    }
+
+    std::string ResponseFile::Resolve(std::string_view path) const {
+        std::filesystem::path nested(path);
+        if (nested.is_absolute()) {
+            return std::string(path);
+        }
+        return (std::filesystem::path(path_).parent_path() / nested).string();
+    }
+
+    bool ResponseFile::IsValid() const {
+        return is_valid_;
+    }
+
+    void ResponseFile::ReleaseConsumed(size_t token_begin) {
+        if (token_begin - released_ >= kReleaseChunk) {
+            file_.Discard(token_begin);
+            released_ = token_begin;
+        }
+    }
+
+    bool ResponseFile::Next(std::string_view& token) {
+        if (!is_valid_) {
+            return false;
+        }
+        while (pos_ < size_ && IsSpace(data_[pos_])) {
+            ++pos_;
+        }
+        if (pos_ == size_) {
+            return false;
+        }
+        ReleaseConsumed(pos_);
+        size_t begin = pos_;
+        while (pos_ < size_ && !IsSpace(data_[pos_])) {
+            char ch = data_[pos_];
+            if (ch == '\'' || ch == '"' || ch == '\\') {
+                scratch_.assign(data_ + begin, pos_ - begin);
+                return ReadQuoted(token);
+            }
+            ++pos_;
+        }
+        token = std::string_view(data_ + begin, pos_ - begin);
+        return true;
+    }
+
+    // Rest of a token that needs unescaping, appended to scratch_.
+    bool ResponseFile::ReadQuoted(std::string_view& token) {
+        while (pos_ < size_ && !IsSpace(data_[pos_])) {
+            char ch = data_[pos_++];
+            if (ch == '\'') {
+                size_t begin = pos_;
+                while (pos_ < size_ && data_[pos_] != '\'') {
+                    ++pos_;
+                }
+                if (pos_ == size_) {
+                    is_valid_ = false;
+                    return false;
+                }
+                scratch_.append(data_ + begin, pos_ - begin);
+                ++pos_;
+            } else if (ch == '"') {
+                while (pos_ < size_ && data_[pos_] != '"') {
+                    if (data_[pos_] == '\\' && pos_ + 1 < size_ && (data_[pos_ + 1] == '"' || data_[pos_ + 1] == '\\')) {
+                        ++pos_;
+                    }
+                    scratch_.push_back(data_[pos_++]);
+                }
+                if (pos_ == size_) {
+                    is_valid_ = false;
+                    return false;
+                }
+                ++pos_;
+            } else if (ch == '\\') {
+                if (pos_ < size_) {
+                    scratch_.push_back(data_[pos_++]);
+                }
+            } else {
+                scratch_.push_back(ch);
+            }
+        }
+        token = scratch_;
+        return true;
+    }
+
+} // namespace ArgumentParser
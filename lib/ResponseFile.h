@@ -0,0 +1,73 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ArgumentParser {
+
+    // Reads the tokens of a response file ("@path" on the command line) one at
+    // a time. The file is memory-mapped and plain tokens are views straight into
+    // the mapping; only tokens with quotes or backslashes are unescaped into a
+    // scratch buffer. Pages that have been tokenized are handed back to the
+    // kernel, so memory use does not grow with the size of the file.
+    //
+    // Quoting follows the shell: whitespace separates tokens, '...' is taken
+    // literally, "..." honours \" and \\, and a backslash outside quotes escapes
+    // the next character.
+    class ResponseFile {
+    public:
+        bool Open(const std::string& path);
+        // Path of an "@path" token inside this file: relative paths are taken
+        // relative to the directory of this file, as GCC and MSVC do.
+        std::string Resolve(std::string_view path) const;
+        // The token stays valid until the next call. Returns false at the end
+        // of the file or on a syntax error, see IsValid.
+        bool Next(std::string_view& token);
+        // False if the file could not be read or has an unterminated quote.
+        bool IsValid() const;
+
+    private:
+        bool ReadQuoted(std::string_view& token);
+        void ReleaseConsumed(size_t token_begin);
+
+        MappedFile file_;
+        std::string path_;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        size_t pos_ = 0;
+        size_t released_ = 0; // bytes at the front already handed to Discard
+        bool is_valid_ = false;
+        std::string scratch_;
+    };
+
+    constexpr size_t kMaxResponseFileDepth = 16;
+
+    // Hands token to a ParseEngine, or with expand set the tokens of the
+    // response file an "@path" token names, recursively. Paths on the command
+    // line are relative to the working directory, nested ones to the file
+    // that names them (enclosing).
+    template <typename Engine>
+    void FeedToken(Engine& engine, std::string_view token, bool expand, size_t depth = 0,
+                   const ResponseFile* enclosing = nullptr) {
+        if (!expand || token.size() < 2 || token[0] != '@') {
+            engine.ProcessToken(token);
+            return;
+        }
+        ResponseFile file;
+        std::string path = enclosing != nullptr ? enclosing->Resolve(token.substr(1)) : std::string(token.substr(1));
+        if (depth == kMaxResponseFileDepth || !file.Open(path)) {
+            engine.Fail();
+            return;
+        }
+        std::string_view file_token;
+        while (!engine.IsHelp() && file.Next(file_token)) {
+            FeedToken(engine, file_token, expand, depth + 1, &file);
+        }
+        if (!file.IsValid()) {
+            engine.Fail();
+        }
+    }
+
+} // namespace ArgumentParser
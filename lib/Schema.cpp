@@ -0,0 +1,822 @@
+#include "Schema.h"
+#include "ArgSettings.h"
+#include "ParseEngine.h"
+#include "ResponseFile.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
+#include <ostream>
+#include <span>
+namespace ArgumentParser {
+    namespace {
+        constexpr size_t kConversionChunk = size_t{1} << 14;
+
+        template <typename Value>
+        bool ConvertValue(std::string_view token, Value& value, bool allow_non_finite) {
+            if constexpr (std::is_integral_v<Value>) {
+                return ConvertInteger(token, value);
+            } else {
+                return ConvertReal(token, value, allow_non_finite);
+            }
+        }
+
+        // Converts tokens[begin, begin + out.size()) into out, in parallel
+        // chunks if a pool is given.
+        template <typename Value, typename Tokens>
+        bool ConvertRun(const Tokens& tokens, size_t begin, std::span<Value> out, ThreadPool* pool,
+                        bool allow_non_finite) {
+            auto convert = [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    if (!ConvertValue(std::string_view(tokens[begin + i]), out[i], allow_non_finite)) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            if (pool == nullptr || out.size() <= kConversionChunk) {
+                return convert(0, out.size());
+            }
+            std::atomic<bool> is_converted = true;
+            pool->ParallelFor((out.size() + kConversionChunk - 1) / kConversionChunk, [&](size_t chunk, size_t) {
+                if (!convert(chunk * kConversionChunk, std::min(out.size(), (chunk + 1) * kConversionChunk))) {
+                    is_converted.store(false, std::memory_order_relaxed);
+                }
+            });
+            return is_converted;
+        }
+
+        // End of the run of plain value tokens that starts at begin.
+        template <typename Tokens>
+        size_t ValueRunEnd(const Tokens& tokens, size_t begin, const Schema& schema, bool expand) {
+            size_t end = begin;
+            for (; end < tokens.size(); ++end) {
+                std::string_view token = tokens[end];
+                if ((!token.empty() && token[0] == '-') || (expand && token.size() > 1 && token[0] == '@') ||
+                    (schema.HasSubcommands() && schema.FindSubcommand(token) != Schema::kNoArgument)) {
+                    break;
+                }
+            }
+            return end;
+        }
+
+        template <typename Engine, typename Tokens, typename Pool>
+        void FeedValueRun(Engine& engine, ArgumentSettings& target, const Tokens& tokens,
+                          size_t begin, size_t end, Pool& conversion) {
+            std::unique_lock lock(conversion.mutex, std::try_to_lock);
+            ThreadPool* pool = lock.owns_lock() ? &conversion.pool : nullptr;
+            size_t count = end - begin;
+            bool is_converted = false;
+            bool allow_non_finite = target.AllowsNonFinite();
+            switch (target.GetType()) {
+                case ArgumentSettings::Type::Int:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<int>(count), pool, allow_non_finite);
+                    break;
+                case ArgumentSettings::Type::Double:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<double>(count), pool, allow_non_finite);
+                    break;
+                case ArgumentSettings::Type::Float:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<float>(count), pool, allow_non_finite);
+                    break;
+                case ArgumentSettings::Type::Int64:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<int64_t>(count), pool, allow_non_finite);
+                    break;
+                case ArgumentSettings::Type::UInt64:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<uint64_t>(count), pool, allow_non_finite);
+                    break;
+                default:
+                    is_converted = ConvertRun(tokens, begin, target.AppendValues<uint32_t>(count), pool, allow_non_finite);
+                    break;
+            }
+            if (is_converted) {
+                engine.AcceptBulkValues();
+                return;
+            }
+            // the engine decides what a bad token means
+            target.DropValues(count);
+            for (size_t i = begin; i < end; ++i) {
+                engine.SetToken(i, tokens[i]);
+                engine.ProcessToken(tokens[i]);
+            }
+        }
+
+        // Feeds tokens[1..] to engine up to the first subcommand name and returns
+        // the position of that name, or tokens.size() if there is none.
+        template <typename Engine, typename Tokens, typename Pool>
+        size_t FeedTokens(Engine& engine, const Tokens& tokens, const Schema& schema, bool expand, Pool* conversion) {
+            size_t checked_until = 0; // tokens before this are known to be in a short run
+            for (size_t i = 1; i < tokens.size() && !engine.IsHelp(); ++i) {
+                if (schema.HasSubcommands() && !engine.IsAwaitingValue() &&
+                    schema.FindSubcommand(tokens[i]) != Schema::kNoArgument) {
+                    return i;
+                }
+                if (conversion != nullptr && i >= checked_until) {
+                    if (ArgumentSettings* target = engine.BulkValueTarget()) {
+                        size_t end = ValueRunEnd(tokens, i, schema, expand);
+                        if (end - i >= conversion->min_values) {
+                            FeedValueRun(engine, *target, tokens, i, end, *conversion);
+                            i = end - 1;
+                            continue;
+                        }
+                        checked_until = end;
+                    }
+                }
+                engine.SetToken(i, tokens[i]);
+                FeedToken(engine, tokens[i], expand);
+            }
+            return tokens.size();
+        }
+
+        // descriptions never start further right than this
+        constexpr size_t kMaxNameColumn = 32;
+        // narrower terminals still get this much room for the description
+        constexpr size_t kMinTextColumn = 20;
+
+        struct StringSink {
+            std::string& text;
+
+            void Write(std::string_view part) {
+                text.append(part);
+            }
+
+            void Pad(size_t count) {
+                text.append(count, ' ');
+            }
+        };
+
+        struct StreamSink {
+            std::ostream& out;
+
+            void Write(std::string_view part) {
+                out.write(part.data(), static_cast<std::streamsize>(part.size()));
+            }
+
+            void Pad(size_t count) {
+                static constexpr std::string_view kSpaces = "                                ";
+                for (; count > kSpaces.size(); count -= kSpaces.size()) {
+                    Write(kSpaces);
+                }
+                Write(kSpaces.substr(0, count));
+            }
+        };
+
+        // Writes the words of text after the current column, starting a new line
+        // at column indent whenever the next word would pass width.
+        template <typename Sink>
+        void WriteWrapped(Sink& sink, std::string_view text, size_t indent, size_t width, size_t& column) {
+            size_t limit = width == 0 ? SIZE_MAX : std::max(width, indent + kMinTextColumn);
+            if (column + (column > indent) + text.size() <= limit) {
+                // common case: the rest fits on the current line
+                if (column > indent && !text.empty()) {
+                    sink.Write(" ");
+                    ++column;
+                }
+                sink.Write(text);
+                column += text.size();
+                return;
+            }
+            while (!text.empty()) {
+                size_t end = std::min(text.find(' '), text.size());
+                std::string_view word = text.substr(0, end);
+                text.remove_prefix(std::min(end + 1, text.size()));
+                if (word.empty()) {
+                    continue;
+                }
+                if (column > indent) {
+                    if (column + 1 + word.size() > limit) {
+                        sink.Write("\n");
+                        sink.Pad(indent);
+                        column = indent;
+                    } else {
+                        sink.Write(" ");
+                        ++column;
+                    }
+                }
+                sink.Write(word);
+                column += word.size();
+            }
+        }
+
+        struct BufferSink {
+            std::span<char> buffer;
+            size_t size = 0; // bytes the text needs, even past the buffer end
+
+            void Write(std::string_view part) {
+                if (size < buffer.size()) {
+                    std::copy_n(part.data(), std::min(part.size(), buffer.size() - size), buffer.data() + size);
+                }
+                size += part.size();
+            }
+
+            void Pad(size_t count) {
+                if (size < buffer.size()) {
+                    std::fill_n(buffer.data() + size, std::min(count, buffer.size() - size), ' ');
+                }
+                size += count;
+            }
+        };
+
+        // length of "=<type>", nothing for flags
+        size_t TypeSuffixSize(const ArgumentSettings& setting) {
+            std::string_view name = setting.GetTypeName();
+            return name.empty() ? 0 : name.size() + 3;
+        }
+    } // namespace
+
+    Schema::Schema(const std::string &name) : trie_cache_(std::make_shared<TrieCache>()), parser_name_(name) {}
+
+    std::string_view DefineArgumentName(std::string_view argument) {
+        bool is_short_arg = (argument.size() < 2 || argument[1] != '-');
+        std::string_view name = argument.substr(2 - is_short_arg);
+
+        return name.substr(0, name.find('='));
+    }
+
+    size_t Schema::FindIndex(std::string_view name) const {
+        if (is_frozen_) {
+            uint32_t index = Trie().FindExact(name);
+            return index == NameTrie::kNotFound ? kNoArgument : index;
+        }
+        auto it = long_to_index_.find(name);
+        if (it == long_to_index_.end()) {
+            return kNoArgument;
+        }
+        return it->second;
+    }
+
+    const NameTrie& Schema::Trie() const {
+        TrieCache& cache = *trie_cache_;
+        std::call_once(cache.build_once, [&] {
+            std::vector<std::pair<std::string_view, uint32_t>> entries;
+            entries.reserve(args_.size());
+            for (size_t i = 0; i < args_.size(); ++i) {
+                entries.emplace_back(args_[i].name, static_cast<uint32_t>(i));
+            }
+            cache.trie.Build(std::move(entries));
+        });
+        return cache.trie;
+    }
+
+    Schema::OptionMatch Schema::MatchOption(std::string_view name) const {
+        OptionMatch result;
+        if (!abbreviations_ || name.empty()) {
+            result.index = FindIndex(name);
+            return result;
+        }
+        if (!is_frozen_) {
+            // whole names stay a hash lookup; the trie only serves misses
+            result.index = FindIndex(name);
+            if (result.index != kNoArgument) {
+                return result;
+            }
+        }
+        NameTrie::Match match = Trie().Find(name);
+        uint32_t index = match.exact != NameTrie::kNotFound ? match.exact : match.unique;
+        if (index != NameTrie::kNotFound) {
+            result.index = index;
+        } else {
+            // a prefix with neither an exact nor a unique name below it has several
+            result.is_ambiguous = match.is_prefix;
+        }
+        return result;
+    }
+
+    std::vector<size_t> Schema::FindCandidates(std::string_view name) const {
+        const NameTrie& trie = Trie();
+        std::vector<uint32_t> found;
+        NameTrie::Match match = trie.Find(name);
+        if (match.matched > 0) {
+            trie.Collect(match.node, found);
+        }
+        return std::vector<size_t>(found.begin(), found.end());
+    }
+
+    size_t Schema::FindShortIndex(char ch) const {
+        uint32_t index = short_to_index_[static_cast<unsigned char>(ch)];
+        return index == 0 ? kNoArgument : index - 1;
+    }
+
+    ArgumentSettings* Schema::LastAdded() {
+        ++version_;
+        return last_added_ == kNoArgument ? nullptr : &args_[last_added_].settings;
+    }
+
+    template <typename Tokens>
+    bool Schema::ParseTokens(const Tokens& tokens, ParseResult& result) const {
+        result.Reset(*this);
+        if (tokens.empty()) {
+            return false;
+        }
+        if (pre_scan_) {
+            ParseEngine<ParseResult> counter = result.MakeEngine(true);
+            FeedTokens(counter, tokens, *this, response_files_, conversion_.get());
+            result.ReserveCounted();
+        }
+        ParseEngine<ParseResult> engine = result.MakeEngine();
+        size_t subcommand_begin = FeedTokens(engine, tokens, *this, response_files_, conversion_.get());
+        bool is_parsed = result.Finish(engine);
+        if (subcommand_begin == tokens.size() || result.IsHelp()) {
+            return is_parsed;
+        }
+        size_t index = FindSubcommand(tokens[subcommand_begin]);
+        ParseResult& subcommand_result = result.StartSubcommand(index, subcommand_begin);
+        GetSubcommand(index).ParseTokens(std::span(tokens).subspan(subcommand_begin), subcommand_result);
+        return result.FinishSubcommand();
+    }
+
+    bool Schema::Parse(const std::vector<std::string>& args, ParseResult& result) const {
+        return ParseTokens(args, result);
+    }
+
+    bool Schema::Parse(int argc, char** argv, ParseResult& result) const {
+        return ParseTokens(std::span<const char* const>(argv, argc), result);
+    }
+
+    ParseResult Schema::Parse(const std::vector<std::string>& args) const {
+        ParseResult result(*this);
+        Parse(args, result);
+        return result;
+    }
+
+    ParseResult Schema::Parse(int argc, char** argv) const {
+        ParseResult result(*this);
+        Parse(argc, argv, result);
+        return result;
+    }
+
+    bool Schema::HasHelp() const {
+        return help_argument_ != kNoArgument;
+    }
+
+    size_t Schema::Size() const {
+        return args_.size();
+    }
+
+    std::string_view Schema::GetName(size_t index) const {
+        return args_[index].name;
+    }
+
+    char Schema::GetShortName(size_t index) const {
+        return args_[index].short_name;
+    }
+
+    const ArgumentSettings& Schema::GetDefinition(size_t index) const {
+        return args_[index].settings;
+    }
+
+    size_t Schema::GetPositionalIndex() const {
+        return last_positional_;
+    }
+
+    size_t Schema::GetHelpIndex() const {
+        return help_argument_;
+    }
+
+    uint64_t Schema::GetVersion() const {
+        return version_;
+    }
+
+    bool Schema::HasFallbacks() const {
+        return has_env_ || config_ != nullptr;
+    }
+
+    const char* Schema::FindEnvValue(size_t index) const {
+        const std::string& variable = args_[index].env_variable;
+        return variable.empty() ? nullptr : std::getenv(variable.c_str());
+    }
+
+    bool Schema::HasSubcommands() const {
+        return !subcommands_.empty();
+    }
+
+    size_t Schema::FindSubcommand(std::string_view name) const {
+        auto it = subcommand_to_index_.find(name);
+        return it == subcommand_to_index_.end() ? kNoArgument : it->second;
+    }
+
+    std::string_view Schema::GetSubcommandName(size_t index) const {
+        return subcommands_[index]->name;
+    }
+
+    const Schema& Schema::GetSubcommand(size_t index) const {
+        SubcommandRecord& record = *subcommands_[index];
+        std::call_once(record.build_once, [&] {
+            record.schema = std::make_unique<Schema>(parser_name_ + " " + record.name);
+            if (record.factory) {
+                record.factory(*record.schema);
+            }
+            record.is_built = true;
+        });
+        return *record.schema;
+    }
+
+    bool Schema::IsSubcommandBuilt(size_t index) const {
+        return subcommands_[index]->is_built;
+    }
+
+    std::span<const std::string_view> Schema::FindConfigValues(size_t index) const {
+        if (config_ == nullptr) {
+            return {};
+        }
+        return config_->Find(args_[index].name);
+    }
+
+    void Schema::Thaw() {
+        is_frozen_ = false;
+        long_to_index_.clear();
+        for (size_t i = 0; i < args_.size(); ++i) {
+            long_to_index_.emplace(args_[i].name, i);
+        }
+    }
+
+    Schema &Schema::AddSubcommand(const std::string& name, SubcommandFactory factory, const std::string& description) {
+        ++version_;
+        auto record = std::make_shared<SubcommandRecord>();
+        record->name = name;
+        record->description = description;
+        record->factory = std::move(factory);
+        auto [it, is_new] = subcommand_to_index_.emplace(name, subcommands_.size());
+        if (is_new) {
+            subcommands_.push_back(std::move(record));
+        } else {
+            subcommands_[it->second] = std::move(record);
+        }
+        return *this;
+    }
+
+    Schema &Schema::PreScan(bool enabled) {
+        pre_scan_ = enabled;
+        return *this;
+    }
+
+    bool Schema::HasResponseFiles() const {
+        return response_files_;
+    }
+
+    Schema &Schema::ResponseFiles(bool enabled) {
+        response_files_ = enabled;
+        return *this;
+    }
+
+    Schema &Schema::ParallelConversion(size_t thread_count, size_t min_values) {
+        conversion_ = std::make_shared<ConversionPool>(thread_count, std::max<size_t>(min_values, 1));
+        return *this;
+    }
+
+    Schema &Schema::Abbreviations(bool enabled) {
+        abbreviations_ = enabled;
+        return *this;
+    }
+
+    Schema &Schema::Freeze() {
+        Trie();
+        long_to_index_ = {};
+        is_frozen_ = true;
+
+        help_cache_.clear();
+        StringSink sink{help_cache_};
+        RenderHelp(sink);
+        help_cache_version_ = version_;
+        return *this;
+    }
+
+    Schema &Schema::DefineArgument(char ch, const std::string& name,
+        ArgumentSettings settings, const std::string& description) {
+        if (is_frozen_) {
+            Thaw();
+        }
+        ++version_;
+        size_t index = FindIndex(name);
+        if (index == kNoArgument) {
+            index = args_.size();
+            args_.emplace_back().name = name;
+            long_to_index_.emplace(name, index);
+            trie_cache_ = std::make_shared<TrieCache>();
+        }
+        args_[index].settings = std::move(settings);
+        args_[index].description = description;
+        args_[index].env_variable.clear();
+        if (ch != '\0') {
+            args_[index].short_name = ch;
+            short_to_index_[static_cast<unsigned char>(ch)] = static_cast<uint32_t>(index + 1);
+        }
+        last_added_ = index;
+        return *this;
+    }
+
+    Schema &Schema::AddStringArgument(const std::string& str, const std::string& description) {
+        return DefineArgument('\0', str, ArgumentSettings(ArgumentSettings::Type::String), description);
+    }
+
+    Schema &Schema::AddStringArgument(const char& ch, const std::string& str2, const std::string& description) {
+        return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::String), description);
+    }
+
+    Schema &Schema::AddIntArgument(const std::string& str, const std::string& description) {
+        return DefineArgument('\0', str, ArgumentSettings(ArgumentSettings::Type::Int), description);
+    }
+
+    Schema &Schema::AddIntArgument(const char& ch, const std::string& str2, const std::string& description) {
+        return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Int), description);
+    }
+
+    Schema &Schema::AddDoubleArgument(const std::string& str, const std::string& description) {
+        return DefineArgument('\0', str, ArgumentSettings(ArgumentSettings::Type::Double), description);
+    }
+
+    Schema &Schema::AddDoubleArgument(const char& ch, const std::string& str2, const std::string& description) {
+        return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Double), description);
+    }
+
+    Schema &Schema::AddFloatArgument(const std::string& str, const std::string& description) {
+        return DefineArgument('\0', str, ArgumentSettings(ArgumentSettings::Type::Float), description);
+    }
+
+    Schema &Schema::AddFloatArgument(const char& ch, const std::string& str2, const std::string& description) {
+        return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Float), description);
+    }
+
+    Schema &Schema::AddFlag(const std::string& str, const std::string& description) {
+        return DefineArgument('\0', str, ArgumentSettings(ArgumentSettings::Type::Flag), description);
+    }
+
+    Schema &Schema::AddFlag(const char& ch, const std::string& str2, const std::string& description) {
+        DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Flag), description);
+        LastAdded()->SetOptional();
+        return *this;
+    }
+
+    Schema &Schema::AddHelp(const char& ch, const std::string& str2, const std::string& description) {
+        AddFlag(ch, str2, description);
+        help_argument_ = last_added_;
+        return *this;
+    }
+
+
+    Schema &Schema::MultiValue(size_t minimum_size) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetMultiValue(minimum_size);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValues(std::vector<std::string>& container) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValues(container);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValues(std::vector<int>& container) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValues(container);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValue(std::string& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValue(int& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValue(bool& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValues(std::vector<double>& container) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValues(container);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValues(std::vector<float>& container) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValues(container);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValue(double& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::StoreValue(float& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetStoreValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::Positional() {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetPositional();
+            last_positional_ = last_added_;
+        }
+        return *this;
+    }
+
+    Schema &Schema::Lazy() {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetLazy();
+        }
+        return *this;
+    }
+
+    Schema &Schema::NonFinite() {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetNonFinite();
+        }
+        return *this;
+    }
+
+    Schema &Schema::Default(const char* value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetDefaultValue(static_cast<std::string>(value));
+        }
+        return *this;
+    }
+
+    Schema &Schema::Default(const int& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetDefaultValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::Default(const bool& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetDefaultValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::Default(const double& value) {
+        if (ArgumentSettings* setting = LastAdded()) {
+            setting->SetDefaultValue(value);
+        }
+        return *this;
+    }
+
+    Schema &Schema::Env(const std::string& variable) {
+        if (LastAdded() != nullptr) {
+            args_[last_added_].env_variable = variable;
+            has_env_ = true;
+        }
+        return *this;
+    }
+
+    Schema &Schema::ConfigFile(const std::string& path) {
+        config_ = std::make_shared<const ConfigSource>(path);
+        return *this;
+    }
+
+    template <typename Sink>
+    void Schema::RenderHelp(Sink& sink) const {
+        sink.Write(parser_name_);
+        sink.Write("\n");
+        if (help_argument_ != kNoArgument) {
+            sink.Write(args_[help_argument_].description);
+            sink.Write("\n");
+        }
+        sink.Write("\n");
+
+        // "-s,  --name=<type>," and the longest of those decides the column
+        size_t name_column = 0;
+        for (size_t i = 0; i < args_.size(); ++i) {
+            if (i != help_argument_) {
+                size_t width = 8 + args_[i].name.size() + TypeSuffixSize(args_[i].settings);
+                name_column = std::max(name_column, std::min(width, kMaxNameColumn));
+            }
+        }
+        for (const auto& subcommand : subcommands_) {
+            name_column = std::max(name_column, std::min(2 + subcommand->name.size(), kMaxNameColumn));
+        }
+        size_t text_column = name_column + 2;
+
+        for (size_t i = 0; i < args_.size(); ++i) {
+            if (i == help_argument_) {
+                continue;
+            }
+            const ArgumentRecord& record = args_[i];
+            const ArgumentSettings& setting = record.settings;
+            if (record.short_name != '\0') {
+                char prefix[] = {'-', record.short_name, ',', ' ', ' '};
+                sink.Write(std::string_view(prefix, sizeof(prefix)));
+            } else {
+                sink.Write("     ");
+            }
+            sink.Write("--");
+            sink.Write(record.name);
+            std::string_view type_name = setting.GetTypeName();
+            if (!type_name.empty()) {
+                sink.Write("=<");
+                sink.Write(type_name);
+                sink.Write(">");
+            }
+            sink.Write(",");
+
+            size_t width = 8 + record.name.size() + TypeSuffixSize(setting);
+            if (width > name_column) {
+                sink.Write("\n");
+                sink.Pad(text_column);
+            } else {
+                sink.Pad(text_column - width);
+            }
+            size_t column = text_column;
+            WriteWrapped(sink, record.description, text_column, help_width_, column);
+            if (setting.IsMultiValue()) {
+                char repeated[48] = "[repeated, min args = ";
+                char* end = repeated + std::char_traits<char>::length(repeated);
+                end = std::to_chars(end, repeated + sizeof(repeated) - 1, setting.GetMinCount()).ptr;
+                *end++ = ']';
+                WriteWrapped(sink, std::string_view(repeated, end - repeated), text_column, help_width_, column);
+            }
+            sink.Write("\n");
+        }
+
+        if (!subcommands_.empty()) {
+            sink.Write("\nSubcommands:\n");
+        }
+        for (const auto& subcommand : subcommands_) {
+            sink.Write("  ");
+            sink.Write(subcommand->name);
+            size_t width = 2 + subcommand->name.size();
+            if (width > name_column) {
+                sink.Write("\n");
+                sink.Pad(text_column);
+            } else {
+                sink.Pad(text_column - width);
+            }
+            size_t column = text_column;
+            WriteWrapped(sink, subcommand->description, text_column, help_width_, column);
+            sink.Write("\n");
+        }
+
+        if (help_argument_ != kNoArgument) {
+            char prefix[] = {'\n', '-', args_[help_argument_].short_name, ',', ' ', '-', '-'};
+            sink.Write(std::string_view(prefix, sizeof(prefix)));
+            sink.Write(args_[help_argument_].name);
+            sink.Write(" Display this help and exit\n");
+        }
+    }
+
+    bool Schema::IsHelpCached() const {
+        return help_cache_version_ == version_;
+    }
+
+    std::string Schema::HelpDescription() const {
+        if (IsHelpCached()) {
+            return help_cache_;
+        }
+        std::string text;
+        StringSink sink{text};
+        RenderHelp(sink);
+        return text;
+    }
+
+    void Schema::WriteHelp(std::ostream& out) const {
+        if (IsHelpCached()) {
+            out.write(help_cache_.data(), static_cast<std::streamsize>(help_cache_.size()));
+            return;
+        }
+        StreamSink sink{out};
+        RenderHelp(sink);
+    }
+
+    size_t Schema::WriteHelp(std::span<char> buffer) const {
+        if (IsHelpCached()) {
+            std::copy_n(help_cache_.data(), std::min(buffer.size(), help_cache_.size()), buffer.data());
+            return help_cache_.size();
+        }
+        BufferSink sink{buffer};
+        RenderHelp(sink);
+        return sink.size;
+    }
+
+    Schema &Schema::HelpWidth(size_t columns) {
+        help_width_ = columns;
+        if (IsHelpCached()) {
+            help_cache_.clear();
+            StringSink sink{help_cache_};
+            RenderHelp(sink);
+        }
+        return *this;
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "ArgSettings.h"
+#include "ConfigSource.h"
+#include "NameTrie.h"
+#include "Option.h"
+#include "ParseResult.h"
+#include "ThreadPool.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ArgumentParser {
+
+    struct StringHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view str) const {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    template <typename T>
+    using StringMap = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
+    // Argument definitions, built with the fluent Add* API. Parsing never
+    // modifies a Schema: every Parse call fills a separate ParseResult, so one
+    // schema can be shared by any number of threads once it is built. Values
+    // bound with StoreValue(s) are still written by every parse, so schemas used
+    // concurrently should not bind them.
+    class Schema {
+    public:
+        static constexpr size_t kNoArgument = SIZE_MAX;
+        using SubcommandFactory = std::function<void(Schema&)>;
+        static constexpr size_t kParallelMinValues = size_t{1} << 15;
+
+        explicit Schema(const std::string& name = "");
+
+        ParseResult Parse(const std::vector<std::string>& args) const;
+        ParseResult Parse(int argc, char** argv) const;
+        // Reuses the storage of a previous result of this schema.
+        bool Parse(const std::vector<std::string>& args, ParseResult& result) const;
+        bool Parse(int argc, char** argv, ParseResult& result) const;
+
+        Schema &AddStringArgument(const std::string& str, const std::string& description = "");
+        Schema &AddStringArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        Schema &AddIntArgument(const std::string& str, const std::string& description = "");
+        Schema &AddIntArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        Schema &AddDoubleArgument(const std::string& str, const std::string& description = "");
+        Schema &AddDoubleArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        Schema &AddFloatArgument(const std::string& str, const std::string& description = "");
+        Schema &AddFloatArgument(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        Schema &AddFlag(const std::string& str, const std::string& description = "");
+        Schema &AddFlag(const char& ch, const std::string& str2 = "", const std::string& description = "");
+        Schema &AddHelp(const char& ch, const std::string& str2 = "", const std::string& description = "");
+
+        // Argument of type T: bool, int, std::string, double and float map to
+        // the Add*Argument above, anything else is converted by
+        // ValueConverter<T> (integers of every width are built in).
+        template <typename T>
+        Schema &AddArgument(const std::string& str, const std::string& description = "") {
+            return AddArgument<T>('\0', str, description);
+        }
+
+        template <typename T>
+        Schema &AddArgument(const char& ch, const std::string& str2 = "", const std::string& description = "") {
+            if constexpr (std::is_same_v<T, bool>) {
+                return AddFlag(ch, str2, description);
+            } else if constexpr (std::is_same_v<T, int>) {
+                return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Int), description);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::String), description);
+            } else if constexpr (std::is_same_v<T, double>) {
+                return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Double), description);
+            } else if constexpr (std::is_same_v<T, float>) {
+                return DefineArgument(ch, str2, ArgumentSettings(ArgumentSettings::Type::Float), description);
+            } else {
+                static_assert(requires(std::string_view token, T& value) { ValueConverter<T>::Convert(token, value); },
+                              "specialize ArgumentParser::ValueConverter for this type");
+                return DefineArgument(ch, str2, ArgumentSettings::Custom<T>(), description);
+            }
+        }
+
+        Schema& MultiValue(size_t minimum_size = 0);
+        Schema& StoreValues(std::vector<std::string>& container);
+        Schema& StoreValues(std::vector<int>& container);
+        Schema& StoreValues(std::vector<double>& container);
+        Schema& StoreValues(std::vector<float>& container);
+        Schema& StoreValue(std::string& value);
+        Schema& StoreValue(int& value);
+        Schema& StoreValue(bool& value);
+        Schema& StoreValue(double& value);
+        Schema& StoreValue(float& value);
+
+        // For AddArgument<T> arguments of other types.
+        template <typename T>
+        Schema& StoreValues(std::vector<T>& container) {
+            if (ArgumentSettings* setting = LastAdded()) {
+                setting->SetStoreValues(container);
+            }
+            return *this;
+        }
+
+        template <typename T>
+        Schema& StoreValue(T& value) {
+            if (ArgumentSettings* setting = LastAdded()) {
+                setting->SetStoreValue(value);
+            }
+            return *this;
+        }
+        Schema& Positional();
+        // See ArgumentSettings::SetLazy.
+        Schema& Lazy();
+        // See ArgumentSettings::SetNonFinite.
+        Schema& NonFinite();
+        Schema& Default(const char* value);
+        Schema& Default(const int& value);
+        Schema& Default(const bool& value);
+        Schema& Default(const double& value);
+
+        // Default of an AddArgument<T> argument, or another arithmetic type
+        // converted to the argument's own.
+        template <typename T>
+        Schema& Default(const T& value) {
+            if (ArgumentSettings* setting = LastAdded()) {
+                setting->SetDefaultValue(value);
+            }
+            return *this;
+        }
+
+        // Handle of the argument added last, for reads without name lookups:
+        //
+        //     Option<int> jobs = schema.AddIntArgument("jobs").Default(1).Handle<int>();
+        //     int count = result.Get(jobs);
+        //
+        // The handle is invalid if that argument does not hold T values.
+        template <typename T>
+        Option<T> Handle() const {
+            if (last_added_ == kNoArgument || !args_[last_added_].settings.Holds<T>()) {
+                return Option<T>();
+            }
+            return Option<T>(last_added_);
+        }
+
+        // Fallback sources for options missing from the command line, tried in
+        // this order before Default: the environment variable named by Env,
+        // then the ConfigFile key equal to the long name. Sources are only
+        // looked at for options the command line left out. A multi-value
+        // option takes the whitespace-separated words of the variable, or
+        // every line of its key. Flags accept true/false, yes/no, on/off, 1/0.
+        Schema& Env(const std::string& variable);
+        // The file is mapped and indexed right away, see ConfigSource.
+        Schema& ConfigFile(const std::string& path);
+
+        // Git-style subcommand ("tool build --jobs 8"). The first token that
+        // names a subcommand, and is not the value of an option, ends the
+        // options of this schema; it and the rest of the line are parsed by the
+        // subcommand's own schema. factory fills that schema the first time the
+        // subcommand is selected, so an unused subcommand costs only its name.
+        Schema& AddSubcommand(const std::string& name, SubcommandFactory factory, const std::string& description = "");
+
+        // Makes Parse walk the tokens twice: the first pass only counts the
+        // values of every multi-value argument, so internal and StoreValues
+        // containers are reserved once to their exact final size instead of
+        // growing value by value. Pays off for long value lists.
+        Schema& PreScan(bool enabled = true);
+
+        // Expands "@path" tokens into the tokens of the response file at path
+        // (see ResponseFile), recursively up to a fixed depth. Nested paths are
+        // relative to the file that names them. A missing or malformed file
+        // makes the parse fail.
+        Schema& ResponseFiles(bool enabled = true);
+
+        // Converts every run of at least min_values plain tokens that goes to one
+        // multi-value numeric argument on a pool of thread_count
+        // threads (0: one per hardware thread), chunk by chunk straight into the
+        // argument's storage, in command-line order. A run with a bad token is
+        // converted again token by token, so the outcome matches a sequential
+        // parse. The pool serves one parse at a time; concurrent parses convert
+        // their runs on their own thread meanwhile.
+        Schema& ParallelConversion(size_t thread_count = 0, size_t min_values = kParallelMinValues);
+
+        // Accepts any unique prefix of a long name on the command line, like
+        // getopt_long: "--verb" for "--verbose". A prefix of several names is
+        // an AmbiguousOption error, see FindCandidates. Lookups of a frozen
+        // schema resolve prefixes in the same pass as whole names.
+        Schema& Abbreviations(bool enabled = true);
+
+        // Compiles the registered long names into a read-only radix trie that
+        // lookups use instead of the hash map. Call it after the last Add*;
+        // adding an argument later drops the trie again.
+        Schema& Freeze();
+
+        // Help text in insertion order, with the descriptions in one aligned
+        // column wrapped to HelpWidth(). Freeze() renders it once and caches
+        // it; until then, and after later changes, every call renders afresh.
+        std::string HelpDescription() const;
+        void WriteHelp(std::ostream& out) const;
+        // Copies as much of the help text as fits into buffer and returns its
+        // full length, like snprintf (no terminating zero is written).
+        size_t WriteHelp(std::span<char> buffer) const;
+        // Terminal width the help text is wrapped to; 0 disables wrapping.
+        Schema& HelpWidth(size_t columns);
+        bool HasHelp() const;
+
+        size_t Size() const;
+        size_t FindIndex(std::string_view name) const;
+        size_t FindShortIndex(char ch) const;
+        // The option a long name from the command line refers to: the name
+        // itself or, with Abbreviations, the only name it is a prefix of.
+        struct OptionMatch {
+            size_t index = kNoArgument;
+            bool is_ambiguous = false; // abbreviates more than one option
+        };
+        OptionMatch MatchOption(std::string_view name) const;
+        // For error messages about name, in byte order: every option an
+        // ambiguous name abbreviates, otherwise the options that share the
+        // longest prefix with it ("did you mean"). Empty if not even the first
+        // character matches.
+        std::vector<size_t> FindCandidates(std::string_view name) const;
+        std::string_view GetName(size_t index) const;
+        char GetShortName(size_t index) const;
+        const ArgumentSettings& GetDefinition(size_t index) const;
+        size_t GetPositionalIndex() const;
+        size_t GetHelpIndex() const;
+        // Changes whenever an argument is added or redefined.
+        uint64_t GetVersion() const;
+        bool HasFallbacks() const;
+        bool HasResponseFiles() const;
+        bool HasSubcommands() const;
+        size_t FindSubcommand(std::string_view name) const;
+        std::string_view GetSubcommandName(size_t index) const;
+        // Runs the factory on first use; safe to call from several threads.
+        const Schema& GetSubcommand(size_t index) const;
+        bool IsSubcommandBuilt(size_t index) const;
+        // nullptr if the argument has no variable or it is not set.
+        const char* FindEnvValue(size_t index) const;
+        std::span<const std::string_view> FindConfigValues(size_t index) const;
+
+    private:
+        struct ArgumentRecord {
+            std::string name;
+            char short_name = '\0';
+            ArgumentSettings settings;
+            std::string description;
+            std::string env_variable;
+        };
+
+        struct ConversionPool {
+            explicit ConversionPool(size_t thread_count, size_t min_values)
+                : pool(thread_count), min_values(min_values) {
+            }
+
+            ThreadPool pool;
+            std::mutex mutex; // held by the parse that uses pool
+            size_t min_values;
+        };
+
+        struct SubcommandRecord {
+            std::string name;
+            std::string description;
+            SubcommandFactory factory;
+            std::once_flag build_once;
+            std::atomic<bool> is_built = false;
+            std::unique_ptr<Schema> schema;
+        };
+
+        ArgumentSettings* LastAdded();
+        Schema& DefineArgument(char ch, const std::string& name,
+            ArgumentSettings settings, const std::string& description);
+        void Thaw();
+        // Built on first use and kept until an argument with a new name is
+        // added; the labels are copied, so copies of the schema can share it.
+        struct TrieCache {
+            std::once_flag build_once;
+            NameTrie trie;
+        };
+
+        const NameTrie& Trie() const;
+        template <typename Tokens>
+        bool ParseTokens(const Tokens& tokens, ParseResult& result) const;
+        template <typename Sink>
+        void RenderHelp(Sink& sink) const;
+        bool IsHelpCached() const;
+
+        bool is_frozen_ = false;
+        bool pre_scan_ = false;
+        bool abbreviations_ = false;
+        bool response_files_ = false;
+        bool has_env_ = false;
+        size_t help_width_ = 80;
+        std::string help_cache_;
+        uint64_t help_cache_version_ = UINT64_MAX; // version_ the cache was rendered for
+        uint64_t version_ = 0;
+        std::vector<ArgumentRecord> args_; // in insertion order
+        StringMap<size_t> long_to_index_;
+        std::shared_ptr<TrieCache> trie_cache_;
+        std::vector<std::shared_ptr<SubcommandRecord>> subcommands_; // built lazily, also for const schemas
+        StringMap<size_t> subcommand_to_index_;
+        std::shared_ptr<const ConfigSource> config_; // shared by copies, it is never modified
+        std::shared_ptr<ConversionPool> conversion_; // nullptr: convert token by token; copies share the pool and its mutex
+        std::array<uint32_t, 256> short_to_index_{}; // index + 1, 0 if the short name is free
+        std::string parser_name_;
+        size_t last_added_ = kNoArgument;
+        size_t last_positional_ = kNoArgument;
+        size_t help_argument_ = kNoArgument;
+    };
+
+} // namespace ArgumentParser
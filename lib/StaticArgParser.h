@@ -0,0 +1,496 @@
+#pragma once
+
+#include "ArgSettings.h"
+#include "Convert.h"
+#include "ParseEngine.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ArgumentParser {
+
+    struct OptionSpec {
+        ArgumentSettings::Type type = ArgumentSettings::Type::Flag;
+        std::string_view long_name;
+        char short_name = '\0';
+        std::string_view description = {};
+        std::string_view default_value = {}; // token converted like a command line value
+        bool multi_value = false;
+        size_t min_count = 0;
+        bool positional = false;
+        bool required = false;
+        bool help = false;
+    };
+
+    namespace detail {
+
+        constexpr uint64_t HashName(std::string_view name) {
+            uint64_t hash = 14695981039346656037ull;
+            for (char ch : name) {
+                hash ^= static_cast<unsigned char>(ch);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        constexpr uint64_t MixHash(uint64_t hash, uint64_t seed) {
+            hash ^= seed * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        // Hash-and-displace perfect hash: names are split into buckets by the
+        // unseeded hash, then every bucket gets its own seed so that all of its
+        // names land in free slots. A lookup costs one pass over the name, two
+        // mixes and a single comparison.
+        template <size_t N>
+        struct PerfectHash {
+            static constexpr size_t kBuckets = N == 0 ? 1 : N;
+            static constexpr size_t kSlots = std::bit_ceil(kBuckets) * 2;
+            static constexpr uint32_t kMaxSeed = 1u << 16;
+
+            std::array<uint32_t, kBuckets> seeds{};
+            std::array<uint32_t, kSlots> slots{}; // option index + 1, 0 marks an empty slot
+            bool has_duplicates = false;
+            bool is_built = false;
+
+            constexpr size_t Slot(uint64_t hash, uint32_t seed) const {
+                return MixHash(hash, seed) & (kSlots - 1);
+            }
+
+            constexpr uint32_t Find(std::string_view name, const std::array<OptionSpec, N>& specs) const {
+                uint64_t hash = HashName(name);
+                uint32_t index = slots[Slot(hash, seeds[hash % kBuckets])];
+                if (index == 0 || specs[index - 1].long_name != name) {
+                    return 0;
+                }
+                return index;
+            }
+        };
+
+        template <size_t N>
+        constexpr PerfectHash<N> BuildPerfectHash(const std::array<OptionSpec, N>& specs) {
+            using Hash = PerfectHash<N>;
+            Hash result;
+            std::array<uint64_t, N> hashes{};
+            std::array<size_t, Hash::kBuckets + 1> bucket_begin{};
+            for (size_t i = 0; i < N; ++i) {
+                hashes[i] = HashName(specs[i].long_name);
+                ++bucket_begin[hashes[i] % Hash::kBuckets + 1];
+            }
+            for (size_t b = 0; b < Hash::kBuckets; ++b) {
+                bucket_begin[b + 1] += bucket_begin[b];
+            }
+            // option indices grouped by bucket
+            std::array<size_t, N> members{};
+            std::array<size_t, Hash::kBuckets> filled{};
+            for (size_t i = 0; i < N; ++i) {
+                size_t bucket = hashes[i] % Hash::kBuckets;
+                members[bucket_begin[bucket] + filled[bucket]++] = i;
+            }
+            // equal names always share a bucket, so only bucket mates need comparing
+            size_t max_bucket_size = 0;
+            for (size_t b = 0; b < Hash::kBuckets; ++b) {
+                max_bucket_size = std::max(max_bucket_size, filled[b]);
+                for (size_t i = bucket_begin[b]; i < bucket_begin[b + 1]; ++i) {
+                    for (size_t j = i + 1; j < bucket_begin[b + 1]; ++j) {
+                        if (specs[members[i]].long_name == specs[members[j]].long_name) {
+                            result.has_duplicates = true;
+                            return result;
+                        }
+                    }
+                }
+            }
+            // place the largest buckets first, while the table is still empty
+            std::array<size_t, Hash::kBuckets> order{};
+            size_t order_size = 0;
+            for (size_t size = max_bucket_size; size > 0; --size) {
+                for (size_t b = 0; b < Hash::kBuckets; ++b) {
+                    if (filled[b] == size) {
+                        order[order_size++] = b;
+                    }
+                }
+            }
+
+            std::array<size_t, N> placed{};
+            for (size_t k = 0; k < order_size; ++k) {
+                size_t bucket = order[k];
+                bool is_placed = false;
+                for (uint32_t seed = 1; seed < Hash::kMaxSeed && !is_placed; ++seed) {
+                    size_t placed_count = 0;
+                    is_placed = true;
+                    for (size_t j = bucket_begin[bucket]; j < bucket_begin[bucket + 1] && is_placed; ++j) {
+                        size_t slot = result.Slot(hashes[members[j]], seed);
+                        if (result.slots[slot] != 0) {
+                            is_placed = false;
+                        } else {
+                            result.slots[slot] = static_cast<uint32_t>(members[j] + 1);
+                            placed[placed_count++] = slot;
+                        }
+                    }
+                    if (is_placed) {
+                        result.seeds[bucket] = seed;
+                    } else {
+                        for (size_t j = 0; j < placed_count; ++j) {
+                            result.slots[placed[j]] = 0;
+                        }
+                    }
+                }
+                if (!is_placed) {
+                    return result;
+                }
+            }
+            result.is_built = true;
+            return result;
+        }
+
+        template <size_t N>
+        constexpr bool HasLongNames(const std::array<OptionSpec, N>& specs) {
+            for (const OptionSpec& spec : specs) {
+                if (spec.long_name.empty()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <size_t N>
+        constexpr bool HasUniqueShortNames(const std::array<OptionSpec, N>& specs) {
+            std::array<bool, 256> is_used{};
+            for (const OptionSpec& spec : specs) {
+                unsigned char ch = static_cast<unsigned char>(spec.short_name);
+                if (ch != 0 && is_used[ch]) {
+                    return false;
+                }
+                is_used[ch] = true;
+            }
+            return true;
+        }
+
+        template <size_t N>
+        constexpr size_t CountPositional(const std::array<OptionSpec, N>& specs) {
+            size_t count = 0;
+            for (const OptionSpec& spec : specs) {
+                count += spec.positional;
+            }
+            return count;
+        }
+
+        template <size_t N>
+        constexpr size_t CountHelp(const std::array<OptionSpec, N>& specs) {
+            size_t count = 0;
+            for (const OptionSpec& spec : specs) {
+                count += spec.help;
+            }
+            return count;
+        }
+
+        template <size_t N>
+        constexpr size_t FindHelp(const std::array<OptionSpec, N>& specs) {
+            for (size_t i = 0; i < N; ++i) {
+                if (specs[i].help) {
+                    return i;
+                }
+            }
+            return N;
+        }
+
+        template <size_t N>
+        constexpr bool HasFlagHelp(const std::array<OptionSpec, N>& specs) {
+            size_t help = FindHelp(specs);
+            return help == N || specs[help].type == ArgumentSettings::Type::Flag;
+        }
+
+        template <size_t N>
+        constexpr std::array<uint32_t, 256> BuildShortTable(const std::array<OptionSpec, N>& specs) {
+            std::array<uint32_t, 256> table{};
+            for (size_t i = 0; i < N; ++i) {
+                if (specs[i].short_name != '\0') {
+                    table[static_cast<unsigned char>(specs[i].short_name)] = static_cast<uint32_t>(i + 1);
+                }
+            }
+            return table;
+        }
+
+    } // namespace detail
+
+    // Parser over a schema fixed at compile time:
+    //
+    //     static constexpr std::array<OptionSpec, 3> kSpecs = {{
+    //         {.type = ArgumentSettings::Type::Int, .long_name = "number", .short_name = 'n', .required = true},
+    //         {.type = ArgumentSettings::Type::Int, .long_name = "jobs", .description = "Workers", .default_value = "4"},
+    //         {.long_name = "help", .short_name = 'h', .description = "Does things", .help = true},
+    //     }};
+    //     StaticArgParser<kSpecs> parser("My Parser");
+    //
+    // Name lookup tables are computed by the compiler, so constructing the
+    // parser does no hashing. The value storage is not: the constructor sets up
+    // one ArgumentSettings per option and converts the default_value tokens; a
+    // default makes the option optional, one that does not convert is ignored.
+    // The help option works like Schema::AddHelp: its description is the
+    // program description, and Parse stops at it and succeeds.
+    template <const auto& Specs>
+    class StaticArgParser {
+        static constexpr size_t kCount = Specs.size();
+        static constexpr detail::PerfectHash<kCount> kLongNames = detail::BuildPerfectHash(Specs);
+        static constexpr std::array<uint32_t, 256> kShortNames = detail::BuildShortTable(Specs);
+
+        static_assert(detail::HasLongNames(Specs), "every option needs a long name");
+        static_assert(!kLongNames.has_duplicates, "option long names must be unique");
+        static_assert(detail::HasUniqueShortNames(Specs), "option short names must be unique");
+        static_assert(detail::CountPositional(Specs) <= 1, "only one option can be positional");
+        static_assert(kLongNames.has_duplicates || kLongNames.is_built, "failed to build a perfect hash for option names");
+        static_assert(detail::CountHelp(Specs) <= 1, "only one option can be the help option");
+        static_assert(detail::HasFlagHelp(Specs), "the help option has to be a flag");
+
+        static constexpr size_t kHelpIndex = detail::FindHelp(Specs);
+
+    public:
+        explicit StaticArgParser(std::string_view name = {}) : name_(name) {
+            for (size_t i = 0; i < kCount; ++i) {
+                const OptionSpec& spec = Specs[i];
+                args_[i] = ArgumentSettings(spec.type);
+                if (spec.multi_value) {
+                    args_[i].SetMultiValue(spec.min_count);
+                }
+                if (spec.positional) {
+                    args_[i].SetPositional();
+                    positional_ = &args_[i];
+                }
+                if (!spec.required) {
+                    args_[i].SetOptional();
+                }
+                if (!spec.default_value.empty()) {
+                    SetDefault(args_[i], spec.type, spec.default_value);
+                }
+            }
+            if constexpr (kHelpIndex != kCount) {
+                help_ = &args_[kHelpIndex];
+            }
+        }
+
+        bool Parse(const std::vector<std::string>& args) {
+            if (args.empty()) {
+                return false;
+            }
+            ResetValues();
+            ParseEngine<StaticArgParser> engine(*this, positional_, help_);
+            for (size_t i = 1; i < args.size() && !engine.IsHelp(); ++i) {
+                engine.ProcessToken(args[i]);
+            }
+            return FinishParse(engine);
+        }
+
+        bool Parse(int argc, char** argv) {
+            if (argc == 0) {
+                return false;
+            }
+            ResetValues();
+            ParseEngine<StaticArgParser> engine(*this, positional_, help_);
+            std::span<const char* const> tokens(argv, argc);
+            for (size_t i = 1; i < tokens.size() && !engine.IsHelp(); ++i) {
+                engine.ProcessToken(tokens[i]);
+            }
+            return FinishParse(engine);
+        }
+
+        bool GetFlag(std::string_view name) const {
+            const ArgumentSettings* setting = FindArgument(name);
+            return setting != nullptr && setting->GetBoolValue();
+        }
+
+        bool GetFlag(char ch) const {
+            const ArgumentSettings* setting = FindShortArgument(ch);
+            return setting != nullptr && setting->GetBoolValue();
+        }
+
+        int GetFlagCount(char ch) const {
+            const ArgumentSettings* setting = FindShortArgument(ch);
+            return setting != nullptr ? setting->GetFlagCount() : 0;
+        }
+
+        int GetIntValue(std::string_view name, int ind = 0) const {
+            const ArgumentSettings* setting = FindArgument(name);
+            if (setting != nullptr) {
+                return setting->GetIntVal(ind);
+            }
+            return -1;
+        }
+
+        std::string GetStringValue(std::string_view name, int ind = 0) const {
+            const ArgumentSettings* setting = FindArgument(name);
+            if (setting != nullptr) {
+                return setting->GetStringVal(ind);
+            }
+            return "";
+        }
+
+        bool IsHelp() const {
+            return is_help_;
+        }
+
+        // Same layout as Schema::HelpDescription, without line wrapping.
+        std::string HelpDescription() const {
+            std::string text(name_);
+            text += '\n';
+            if constexpr (kHelpIndex != kCount) {
+                text += Specs[kHelpIndex].description;
+                text += '\n';
+            }
+            text += '\n';
+
+            size_t name_column = 0;
+            for (size_t i = 0; i < kCount; ++i) {
+                if (i != kHelpIndex) {
+                    name_column = std::max(name_column, NameWidth(i));
+                }
+            }
+            for (size_t i = 0; i < kCount; ++i) {
+                if (i == kHelpIndex) {
+                    continue;
+                }
+                const OptionSpec& spec = Specs[i];
+                if (spec.short_name != '\0') {
+                    text += '-';
+                    text += spec.short_name;
+                    text += ",  ";
+                } else {
+                    text += "     ";
+                }
+                text += "--";
+                text += spec.long_name;
+                std::string_view type_name = args_[i].GetTypeName();
+                if (!type_name.empty()) {
+                    text += "=<";
+                    text += type_name;
+                    text += '>';
+                }
+                text += ',';
+                text.append(name_column + 2 - NameWidth(i), ' ');
+                text += spec.description;
+                if (spec.multi_value) {
+                    text += spec.description.empty() ? "[repeated, min args = " : " [repeated, min args = ";
+                    text += std::to_string(spec.min_count);
+                    text += ']';
+                }
+                text += '\n';
+            }
+
+            if constexpr (kHelpIndex != kCount) {
+                text += "\n";
+                if (Specs[kHelpIndex].short_name != '\0') {
+                    text += '-';
+                    text += Specs[kHelpIndex].short_name;
+                    text += ", ";
+                }
+                text += "--";
+                text += Specs[kHelpIndex].long_name;
+                text += " Display this help and exit\n";
+            }
+            return text;
+        }
+
+    private:
+        friend class ParseEngine<StaticArgParser>;
+
+        ArgumentSettings* FindArgument(std::string_view name) {
+            uint32_t index = kLongNames.Find(name, Specs);
+            return index == 0 ? nullptr : &args_[index - 1];
+        }
+
+        const ArgumentSettings* FindArgument(std::string_view name) const {
+            uint32_t index = kLongNames.Find(name, Specs);
+            return index == 0 ? nullptr : &args_[index - 1];
+        }
+
+        ArgumentSettings* FindShortArgument(char ch) {
+            uint32_t index = kShortNames[static_cast<unsigned char>(ch)];
+            return index == 0 ? nullptr : &args_[index - 1];
+        }
+
+        const ArgumentSettings* FindShortArgument(char ch) const {
+            uint32_t index = kShortNames[static_cast<unsigned char>(ch)];
+            return index == 0 ? nullptr : &args_[index - 1];
+        }
+
+        // "-s,  --name=<type>," as in Schema::RenderHelp
+        size_t NameWidth(size_t i) const {
+            std::string_view type_name = args_[i].GetTypeName();
+            return 8 + Specs[i].long_name.size() + (type_name.empty() ? 0 : type_name.size() + 3);
+        }
+
+        template <typename T>
+        static void SetConvertedDefault(ArgumentSettings& setting, std::string_view token) {
+            T value{};
+            if (ValueConverter<T>::Convert(token, value)) {
+                setting.SetDefaultValue(value);
+            }
+        }
+
+        static void SetDefault(ArgumentSettings& setting, ArgumentSettings::Type type, std::string_view token) {
+            switch (type) {
+                case ArgumentSettings::Type::String:
+                    setting.SetDefaultValue(std::string(token));
+                    break;
+                case ArgumentSettings::Type::Int:
+                    SetConvertedDefault<int>(setting, token);
+                    break;
+                case ArgumentSettings::Type::Double:
+                    SetConvertedDefault<double>(setting, token);
+                    break;
+                case ArgumentSettings::Type::Float:
+                    SetConvertedDefault<float>(setting, token);
+                    break;
+                case ArgumentSettings::Type::Int64:
+                    SetConvertedDefault<int64_t>(setting, token);
+                    break;
+                case ArgumentSettings::Type::UInt64:
+                    SetConvertedDefault<uint64_t>(setting, token);
+                    break;
+                case ArgumentSettings::Type::UInt32:
+                    SetConvertedDefault<uint32_t>(setting, token);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        // Values of the previous parse go, as in ParseResult::Reset.
+        void ResetValues() {
+            is_help_ = false;
+            for (ArgumentSettings& setting : args_) {
+                setting.ResetValues();
+            }
+        }
+
+        bool FinishParse(ParseEngine<StaticArgParser>& engine) {
+            if (engine.IsHelp()) {
+                is_help_ = true;
+                return true;
+            }
+            bool is_parsed = engine.Finish();
+            for (const ArgumentSettings& setting : args_) {
+                is_parsed &= setting.IsParamParsed();
+                if (setting.IsMultiValue()) {
+                    is_parsed &= (static_cast<size_t>(setting.GetSize()) >= setting.GetMinCount());
+                }
+            }
+            return is_parsed;
+        }
+
+        std::string name_;
+        std::array<ArgumentSettings, kCount> args_;
+        ArgumentSettings* positional_ = nullptr;
+        ArgumentSettings* help_ = nullptr;
+        bool is_help_ = false;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,65 @@
+#include "StreamParser.h"
+#include "ResponseFile.h"
+
+namespace ArgumentParser {
+    StreamParser::StreamParser(const Schema& schema, ParseResult& result, CompletionHandler on_complete)
+        : schema_(schema), result_(result), engine_(Start(schema, result, std::move(on_complete))) {
+    }
+
+    StreamParser::~StreamParser() {
+        result_.on_complete_ = nullptr;
+    }
+
+    ParseEngine<ParseResult> StreamParser::Start(const Schema& schema, ParseResult& result, CompletionHandler on_complete) {
+        result.Reset(schema);
+        result.on_complete_ = std::move(on_complete);
+        return result.MakeEngine();
+    }
+
+    void StreamParser::Feed(std::string_view token) {
+        if (is_finished_) {
+            return;
+        }
+        if (subcommand_ != nullptr) {
+            subcommand_->Feed(token);
+            return;
+        }
+        if (engine_.IsHelp()) {
+            return;
+        }
+        if (schema_.HasSubcommands() && !engine_.IsAwaitingValue()) {
+            size_t index = schema_.FindSubcommand(token);
+            if (index != Schema::kNoArgument) {
+                // the options of this schema end here, as in Schema::Parse
+                result_.Finish(engine_);
+                ParseResult& subcommand_result = result_.StartSubcommand(index, next_token_++);
+                subcommand_ = std::make_unique<StreamParser>(schema_.GetSubcommand(index), subcommand_result,
+                                                             result_.on_complete_);
+                return;
+            }
+        }
+        engine_.SetToken(next_token_++, token);
+        FeedToken(engine_, token, schema_.HasResponseFiles());
+    }
+
+    bool StreamParser::Finish() {
+        if (is_finished_) {
+            return result_.IsParsed();
+        }
+        is_finished_ = true;
+        if (subcommand_ == nullptr) {
+            return result_.Finish(engine_);
+        }
+        subcommand_->Finish();
+        return result_.FinishSubcommand();
+    }
+
+    bool StreamParser::IsHelp() const {
+        return subcommand_ != nullptr ? subcommand_->IsHelp() : engine_.IsHelp();
+    }
+
+    bool StreamParser::IsAwaitingValue() const {
+        return subcommand_ != nullptr ? subcommand_->IsAwaitingValue() : engine_.IsAwaitingValue();
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ParseEngine.h"
+#include "ParseResult.h"
+#include "Schema.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace ArgumentParser {
+
+    // Parses a command line token by token, as the tokens arrive from a pipe
+    // or a REPL, without collecting them first:
+    //
+    //     ParseResult result;
+    //     StreamParser stream(schema, result);
+    //     while (ReadToken(input, token)) {
+    //         stream.Feed(token);
+    //     }
+    //     bool is_parsed = stream.Finish();
+    //
+    // The state between tokens (an option still waiting for its values, an
+    // open positional list, a selected subcommand) is kept here. Tokens are
+    // copied or converted by Feed, so they need not outlive the call. Feed
+    // takes arguments only, without the program name; errors count them from
+    // 1 as if it had been there. PreScan and ParallelConversion do not apply.
+    class StreamParser {
+    public:
+        // Called with the result and schema index of every argument as soon as
+        // an occurrence of it on the command line has all of its values: flags
+        // and options with one value right away, multi-value options when the
+        // next option starts, a multi-value positional argument at Finish.
+        // Arguments of a subcommand come with the subcommand's result.
+        using CompletionHandler = std::function<void(const ParseResult& result, size_t index)>;
+
+        StreamParser(const Schema& schema, ParseResult& result, CompletionHandler on_complete = {});
+        ~StreamParser();
+
+        StreamParser(const StreamParser&) = delete;
+        StreamParser& operator=(const StreamParser&) = delete;
+
+        void Feed(std::string_view token);
+        // Closes the command line, applies fallbacks and checks required
+        // arguments, like the end of Schema::Parse; later Feed calls are
+        // ignored.
+        bool Finish();
+        // A help option was fed; the remaining tokens are ignored.
+        bool IsHelp() const;
+        // The last option fed still needs a value.
+        bool IsAwaitingValue() const;
+
+    private:
+        static ParseEngine<ParseResult> Start(const Schema& schema, ParseResult& result, CompletionHandler on_complete);
+
+        const Schema& schema_;
+        ParseResult& result_;
+        ParseEngine<ParseResult> engine_;
+        std::unique_ptr<StreamParser> subcommand_;
+        uint32_t next_token_ = 1;
+        bool is_finished_ = false;
+    };
+
+} // namespace ArgumentParser
@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace ArgumentParser {
+    ThreadPool::ThreadPool(size_t thread_count)
+        : size_(thread_count != 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency())),
+          ranges_(std::make_unique<WorkRange[]>(size_)) {
+        threads_.reserve(size_ - 1);
+        for (size_t worker = 1; worker < size_; ++worker) {
+            threads_.emplace_back([this, worker] { WorkerLoop(worker); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            is_stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    size_t ThreadPool::Size() const {
+        return size_;
+    }
+
+    void ThreadPool::ParallelFor(size_t chunk_count, const std::function<void(size_t, size_t)>& task) {
+        if (size_ == 1 || chunk_count <= 1) {
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+                task(chunk, 0);
+            }
+            return;
+        }
+        for (size_t worker = 0; worker < size_; ++worker) {
+            std::lock_guard lock(ranges_[worker].mutex);
+            ranges_[worker].begin = chunk_count * worker / size_;
+            ranges_[worker].end = chunk_count * (worker + 1) / size_;
+        }
+        {
+            std::lock_guard lock(mutex_);
+            task_ = &task;
+            running_ = size_ - 1;
+            ++generation_;
+        }
+        wake_.notify_all();
+        RunWorker(0);
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return running_ == 0; });
+        task_ = nullptr;
+    }
+
+    bool ThreadPool::TakeChunk(size_t worker, size_t& chunk) {
+        WorkRange& range = ranges_[worker];
+        std::lock_guard lock(range.mutex);
+        if (range.begin == range.end) {
+            return false;
+        }
+        chunk = range.begin++;
+        return true;
+    }
+
+    bool ThreadPool::StealChunk(size_t worker, size_t& chunk) {
+        for (size_t shift = 1; shift < size_; ++shift) {
+            WorkRange& victim = ranges_[(worker + shift) % size_];
+            size_t begin;
+            size_t end;
+            {
+                std::lock_guard lock(victim.mutex);
+                size_t left = victim.end - victim.begin;
+                if (left == 0) {
+                    continue;
+                }
+                end = victim.end;
+                victim.end -= (left + 1) / 2;
+                begin = victim.end;
+            }
+            chunk = begin;
+            WorkRange& own = ranges_[worker];
+            std::lock_guard lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::RunWorker(size_t worker) {
+        size_t chunk;
+        while (TakeChunk(worker, chunk) || StealChunk(worker, chunk)) {
+            (*task_)(chunk, worker);
+        }
+    }
+
+    void ThreadPool::WorkerLoop(size_t worker) {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [&] { return is_stopping_ || generation_ != seen_generation; });
+                if (is_stopping_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            RunWorker(worker);
+            {
+                std::lock_guard lock(mutex_);
+                --running_;
+            }
+            done_.notify_one();
+        }
+    }
+
+} // namespace ArgumentParser
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ArgumentParser {
+
+    // Fixed set of worker threads for chunked data-parallel loops. Every worker
+    // starts with a contiguous range of chunks and takes them from the front;
+    // a worker that runs dry steals the back half of another worker's range,
+    // so uneven chunks do not leave threads idle.
+    class ThreadPool {
+    public:
+        // 0 means one worker per hardware thread. The calling thread is worker 0.
+        explicit ThreadPool(size_t thread_count = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t Size() const;
+
+        // Calls task(chunk, worker) for every chunk in [0, chunk_count) and
+        // returns once all of them are done. task must not throw.
+        void ParallelFor(size_t chunk_count, const std::function<void(size_t, size_t)>& task);
+
+    private:
+        struct WorkRange {
+            std::mutex mutex;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        bool TakeChunk(size_t worker, size_t& chunk);
+        bool StealChunk(size_t worker, size_t& chunk);
+        void RunWorker(size_t worker);
+        void WorkerLoop(size_t worker);
+
+        size_t size_;
+        std::unique_ptr<WorkRange[]> ranges_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(size_t, size_t)>* task_ = nullptr;
+        size_t generation_ = 0;
+        size_t running_ = 0;
+        bool is_stopping_ = false;
+    };
+
+} // namespace ArgumentParser
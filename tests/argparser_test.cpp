@@ -1,8 +1,19 @@
 #include <gtest/gtest.h>
+#include <lib/AllocationCounter.h>
+#include <lib/Arena.h>
 #include <lib/ArgParser.h>
+#include <lib/BatchParser.h>
+#include <lib/Schema.h>
+#include <lib/StaticArgParser.h>
 
 #include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <optional>
+#include <thread>
+#include <unistd.h>
 
 
 using namespace ArgumentParser;
@@ -17,6 +28,63 @@ std::vector<std::string> SplitString(const std::string& str) {
     return {std::istream_iterator<std::string>(iss), std::istream_iterator<std::string>()};
 }
 
+// File in the temp directory named after the process and the running test,
+// so concurrent test runs never share it; removed when it goes out of scope.
+class TempFile {
+public:
+    explicit TempFile(const std::string& name) {
+        const testing::TestInfo* test = testing::UnitTest::GetInstance()->current_test_info();
+        path_ = std::filesystem::temp_directory_path() /
+                ("argparser_" + std::to_string(getpid()) + "_" + test->name() + "_" + name);
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    std::string Path() const {
+        return path_.string();
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+// Sets (or with nullptr unsets) an environment variable until it goes out of
+// scope, then restores the previous value.
+class EnvGuard {
+public:
+    EnvGuard(const char* name, const char* value) : name_(name) {
+        if (const char* previous = std::getenv(name)) {
+            previous_ = previous;
+        }
+        Set(value);
+    }
+
+    EnvGuard(const EnvGuard&) = delete;
+    EnvGuard& operator=(const EnvGuard&) = delete;
+
+    ~EnvGuard() {
+        Set(previous_ ? previous_->c_str() : nullptr);
+    }
+
+    void Set(const char* value) {
+        if (value != nullptr) {
+            setenv(name_.c_str(), value, 1);
+        } else {
+            unsetenv(name_.c_str());
+        }
+    }
+
+private:
+    std::string name_;
+    std::optional<std::string> previous_;
+};
+
 
 TEST(ArgParserTestSuite, EmptyTest) {
     ArgParser parser("My Empty Parser");
@@ -303,3 +371,966 @@ TEST(ArgParserTestSuite, MyTest25) {
     ASSERT_FALSE(parser.GetFlag('u'));
 }
 
+
+TEST(ArgParserTestSuite, ArgvParsingTest) {
+    ArgParser parser("My Parser");
+    std::vector<int> values;
+    parser.AddFlag('f', "flag", "Flag");
+    parser.AddStringArgument('s', "str", "Some String");
+    parser.AddIntArgument("Param1").MultiValue(1).Positional().StoreValues(values);
+
+    const char* argv[] = {"app", "-f", "--str=value", "1", "2", "3"};
+    ASSERT_TRUE(parser.Parse(6, const_cast<char**>(argv)));
+    ASSERT_TRUE(parser.GetFlag('f'));
+    ASSERT_EQ(parser.GetStringValue("str"), "value");
+    ASSERT_EQ(values.size(), 3);
+}
+
+TEST(ArgParserTestSuite, UnknownArgumentTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('f', "flag", "Flag");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --unknown")));
+    ASSERT_FALSE(parser.Parse(SplitString("app -fx")));
+}
+
+constexpr std::array<OptionSpec, 12> kStaticSpecs = {{
+    {.type = ArgumentSettings::Type::Int, .long_name = "number", .short_name = 'n', .required = true},
+    {.type = ArgumentSettings::Type::String, .long_name = "input", .short_name = 'i', .required = true},
+    {.type = ArgumentSettings::Type::String, .long_name = "output", .short_name = 'o'},
+    {.type = ArgumentSettings::Type::Flag, .long_name = "flag1", .short_name = 'a'},
+    {.type = ArgumentSettings::Type::Flag, .long_name = "flag2", .short_name = 'b'},
+    {.type = ArgumentSettings::Type::Flag, .long_name = "flag3", .short_name = 'c'},
+    {.type = ArgumentSettings::Type::Flag, .long_name = "verbose", .short_name = 'v'},
+    {.type = ArgumentSettings::Type::Int, .long_name = "jobs", .short_name = 'j'},
+    {.type = ArgumentSettings::Type::Int, .long_name = "retry"},
+    {.type = ArgumentSettings::Type::String, .long_name = "mode"},
+    {.type = ArgumentSettings::Type::String, .long_name = "tag", .multi_value = true},
+    {.type = ArgumentSettings::Type::Int, .long_name = "Param1", .multi_value = true, .min_count = 1,
+        .positional = true, .required = true},
+}};
+
+TEST(ArgParserTestSuite, StaticSchemaTest) {
+    StaticArgParser<kStaticSpecs> parser;
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 0 1 2 3 -ac --input=file --tag=x --tag=y -j 4")));
+    ASSERT_EQ(parser.GetIntValue("number"), 0);
+    ASSERT_EQ(parser.GetIntValue("Param1", 2), 3);
+    ASSERT_EQ(parser.GetStringValue("input"), "file");
+    ASSERT_EQ(parser.GetStringValue("tag", 1), "y");
+    ASSERT_EQ(parser.GetIntValue("jobs"), 4);
+    ASSERT_TRUE(parser.GetFlag("flag1"));
+    ASSERT_FALSE(parser.GetFlag('b'));
+    ASSERT_TRUE(parser.GetFlag('c'));
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 5 7 --input=other")));
+    ASSERT_EQ(parser.GetIntValue("Param1"), 7);
+    ASSERT_EQ(parser.GetIntValue("Param1", 1), 0);
+    ASSERT_EQ(parser.GetStringValue("tag"), "");
+    ASSERT_FALSE(parser.GetFlag("flag1"));
+    ASSERT_FALSE(parser.Parse(SplitString("app 1 --input=file")));
+}
+
+TEST(ArgParserTestSuite, StaticSchemaFailTest) {
+    StaticArgParser<kStaticSpecs> parser;
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --input=file 1")));
+    ASSERT_FALSE(StaticArgParser<kStaticSpecs>().Parse(SplitString("app -n 1 --input=file 2 --unknown")));
+}
+
+constexpr std::array<OptionSpec, 5> kStaticHelpSpecs = {{
+    {.type = ArgumentSettings::Type::Int, .long_name = "number", .short_name = 'n', .description = "Some Number",
+        .default_value = "7", .required = true},
+    {.type = ArgumentSettings::Type::String, .long_name = "mode", .default_value = "fast"},
+    {.type = ArgumentSettings::Type::Int64, .long_name = "offset", .default_value = "-12345678901"},
+    {.type = ArgumentSettings::Type::Int, .long_name = "Param1", .description = "Values", .multi_value = true,
+        .min_count = 1, .positional = true},
+    {.long_name = "help", .short_name = 'h', .description = "Some Description about program", .help = true},
+}};
+
+TEST(ArgParserTestSuite, StaticHelpTest) {
+    StaticArgParser<kStaticHelpSpecs> parser("My Parser");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app 1 2")));
+    ASSERT_FALSE(parser.IsHelp());
+    ASSERT_EQ(parser.GetIntValue("number"), 7);
+    ASSERT_EQ(parser.GetStringValue("mode"), "fast");
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 3 --mode=slow 1")));
+    ASSERT_EQ(parser.GetIntValue("number"), 3);
+    ASSERT_EQ(parser.GetStringValue("mode"), "slow");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --help --unknown")));
+    ASSERT_TRUE(parser.IsHelp());
+    ASSERT_EQ(parser.HelpDescription(),
+              "My Parser\n"
+              "Some Description about program\n"
+              "\n"
+              "-n,  --number=<int>,   Some Number\n"
+              "     --mode=<string>,  \n"
+              "     --offset=<int>,   \n"
+              "     --Param1=<int>,   Values [repeated, min args = 1]\n"
+              "\n"
+              "-h, --help Display this help and exit\n");
+}
+
+TEST(ArgParserTestSuite, FreezeTest) {
+    ArgParser parser("My Parser");
+    std::vector<int> values;
+    parser.AddFlag('f', "flag", "Flag");
+    parser.AddIntArgument('n', "number", "Some Number");
+    for (int i = 0; i < 1000; ++i) {
+        parser.AddStringArgument("option" + std::to_string(i)).Default("");
+    }
+    parser.AddIntArgument("Param1").MultiValue(1).Positional().StoreValues(values);
+    parser.Freeze();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 7 1 2 3 --option512=value -f")));
+    ASSERT_TRUE(parser.GetFlag('f'));
+    ASSERT_EQ(parser.GetIntValue("number"), 7);
+    ASSERT_EQ(parser.GetStringValue("option512"), "value");
+    ASSERT_EQ(values.size(), 3);
+    ASSERT_FALSE(parser.Parse(SplitString("app --option1000=value")));
+
+    parser.AddIntArgument("late");
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 7 4 --late=52")));
+    ASSERT_EQ(parser.GetIntValue("late"), 52);
+}
+
+TEST(ArgParserTestSuite, ShortClusterTest) {
+    ArgParser parser("My Parser");
+    std::string output;
+    parser.AddFlag('v', "verbose", "Verbosity");
+    parser.AddFlag('a', "all", "All");
+    parser.AddIntArgument('n', "number", "Some Number");
+    parser.AddStringArgument('o', "output", "Output file").StoreValue(output);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -vvv -an5 -ofile")));
+    ASSERT_EQ(parser.GetFlagCount('v'), 3);
+    ASSERT_TRUE(parser.GetFlag("all"));
+    ASSERT_EQ(parser.GetIntValue("number"), 5);
+    ASSERT_EQ(output, "file");
+}
+
+TEST(ArgParserTestSuite, ShortClusterPendingValueTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('v', "verbose", "Verbosity");
+    parser.AddStringArgument('o', "output", "Output file");
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -vo out.txt")));
+    ASSERT_EQ(parser.GetStringValue("output"), "out.txt");
+    ASSERT_FALSE(parser.Parse(SplitString("app -vo")));
+}
+
+TEST(ArgParserTestSuite, MalformedIntTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("param1");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --param1=12a")));
+    ASSERT_FALSE(parser.Parse(SplitString("app --param1=2147483648")));
+    ASSERT_FALSE(parser.Parse(SplitString("app --param1=")));
+    ASSERT_TRUE(parser.Parse(SplitString("app --param1=-2147483648")));
+    ASSERT_EQ(parser.GetIntValue("param1"), -2147483648);
+}
+
+TEST(ArgParserTestSuite, ConvertIntegerTest) {
+    int64_t value = 0;
+    ASSERT_TRUE(ConvertInteger("1234567890123456", value));
+    ASSERT_EQ(value, 1234567890123456);
+    ASSERT_TRUE(ConvertInteger("-9223372036854775808", value));
+    ASSERT_EQ(value, INT64_MIN);
+    ASSERT_TRUE(ConvertInteger("+0000000000000000000042", value));
+    ASSERT_EQ(value, 42);
+    ASSERT_FALSE(ConvertInteger("9223372036854775808", value));
+    ASSERT_FALSE(ConvertInteger("12345678:0123456", value));
+    ASSERT_FALSE(ConvertInteger("-", value));
+
+    uint32_t unsigned_value = 0;
+    ASSERT_TRUE(ConvertInteger("4294967295", unsigned_value));
+    ASSERT_EQ(unsigned_value, 4294967295u);
+    ASSERT_FALSE(ConvertInteger("-1", unsigned_value));
+}
+
+TEST(ArgParserTestSuite, BatchParsingTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('f', "flag", "Flag");
+    parser.AddIntArgument('n', "number", "Some Number");
+    parser.AddStringArgument('s', "str", "Some String").Default("none");
+    parser.AddIntArgument("Param1").MultiValue(1).Positional();
+    parser.Freeze();
+
+    std::vector<std::vector<std::string>> lines;
+    for (int i = 0; i < 5000; ++i) {
+        std::string line = "app -n " + std::to_string(i);
+        for (int j = 0; j < i % 4; ++j) {
+            line += " " + std::to_string(i + j);
+        }
+        if (i % 3 == 0) {
+            line += " -f";
+        }
+        if (i % 5 == 0) {
+            line += " --str=line" + std::to_string(i);
+        }
+        lines.push_back(SplitString(line));
+    }
+
+    BatchParser batch(parser, 4);
+    BatchResult result = batch.Parse(lines);
+
+    ASSERT_EQ(result.Size(), lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        ASSERT_EQ(result.IsParsed(i), i % 4 != 0);
+        if (!result.IsParsed(i)) {
+            continue;
+        }
+        ASSERT_EQ(result.GetIntValue("number", i), i);
+        ASSERT_EQ(result.GetFlag("flag", i), i % 3 == 0);
+        ASSERT_EQ(result.GetStringValue("str", i), i % 5 == 0 ? "line" + std::to_string(i) : "none");
+        std::span<const int> values = result.GetIntValues("Param1", i);
+        ASSERT_EQ(values.size(), i % 4);
+        ASSERT_EQ(values.back(), i + i % 4 - 1);
+    }
+    ASSERT_FALSE(parser.GetFlag("flag"));
+}
+
+TEST(ArgParserTestSuite, SchemaTest) {
+    Schema schema("My Parser");
+    schema.AddIntArgument('n', "number");
+    schema.AddStringArgument("str").Default("none");
+    schema.AddFlag('f', "flag");
+    schema.AddHelp('h', "help", "Some Description about program");
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&schema, &failures, t] {
+            ParseResult result(schema);
+            for (int i = 0; i < 1000; ++i) {
+                int value = t * 1000 + i;
+                std::vector<std::string> line = {"app", "-n", std::to_string(value)};
+                if (i % 2 == 0) {
+                    line.push_back("-f");
+                }
+                failures[t] += !schema.Parse(line, result);
+                failures[t] += result.GetIntValue("number") != value;
+                failures[t] += result.GetFlag('f') != (i % 2 == 0);
+                failures[t] += result.GetStringValue("str") != "none";
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(failures, std::vector<int>(4, 0));
+
+    ParseResult missing = schema.Parse(SplitString("app -f"));
+    ASSERT_FALSE(missing);
+    ParseResult help = schema.Parse(SplitString("app --help"));
+    ASSERT_TRUE(help.IsHelp());
+}
+
+TEST(ArgParserTestSuite, ReparseTest) {
+    ArgParser parser("My Parser");
+    parser.AddFlag('f', "flag");
+    parser.AddIntArgument("param").MultiValue();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -f --param=1 --param=2")));
+    ASSERT_EQ(parser.GetIntValue("param", 1), 2);
+    ASSERT_TRUE(parser.Parse(SplitString("app --param=3")));
+    ASSERT_FALSE(parser.GetFlag("flag"));
+    ASSERT_EQ(parser.GetIntValue("param", 0), 3);
+    ASSERT_EQ(parser.GetResult().GetSettings(1).GetSize(), 1);
+}
+
+TEST(ArgParserTestSuite, ArenaTest) {
+    Schema schema("My Parser");
+    schema.AddStringArgument('s', "str").MultiValue(1);
+    schema.AddIntArgument("Param1").MultiValue().Positional();
+
+    ParseResult result(schema);
+    for (int i = 0; i < 100; ++i) {
+        std::string value = "a long value that does not fit into the small string buffer " + std::to_string(i);
+        ASSERT_TRUE(schema.Parse({"app", "-s", value, "--str=" + value, "1", "2", std::to_string(i)}, result));
+        ASSERT_EQ(result.GetStringValue("str", 1), value);
+        ASSERT_EQ(result.GetIntValue("Param1", 2), i);
+    }
+
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    ParseResult external(schema, &resource);
+    ASSERT_TRUE(schema.Parse(SplitString("app -s first --str=second 7"), external));
+    ASSERT_EQ(external.GetStringValue("str", 1), "second");
+    ASSERT_EQ(external.GetIntValue("Param1"), 7);
+}
+
+TEST(ArgParserTestSuite, ArenaResetTest) {
+    Arena arena(64);
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    values = std::pmr::vector<int>(&arena);
+    arena.Reset();
+    size_t capacity = arena.Capacity();
+    for (int round = 0; round < 3; ++round) {
+        std::pmr::vector<int> reused(&arena);
+        reused.reserve(1000);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(reused.data()) % alignof(int), 0);
+        reused.clear();
+        arena.Reset();
+    }
+    ASSERT_EQ(arena.Capacity(), capacity);
+}
+
+TEST(ArgParserTestSuite, SettingsLayoutTest) {
+    ::testing::Test::RecordProperty("sizeof_ArgumentSettings", static_cast<int>(sizeof(ArgumentSettings)));
+    ASSERT_LE(sizeof(ArgumentSettings), 128);
+
+    ArgumentSettings setting(ArgumentSettings::Type::Int);
+    setting.SetDefaultValue(5).SetDefaultValue("ignored");
+    ASSERT_EQ(setting.GetIntVal(), 5);
+    ASSERT_EQ(setting.GetStringView(), "");
+    setting.AddValue(7);
+    ASSERT_EQ(setting.GetIntVal(), 7);
+    ArgumentSettings clone = setting.CloneDefinition();
+    ASSERT_EQ(clone.GetType(), ArgumentSettings::Type::Int);
+    ASSERT_EQ(clone.GetIntVal(), 5);
+}
+
+TEST(ArgParserTestSuite, PreScanTest) {
+    ArgParser parser("My Parser");
+    std::vector<int> values;
+    std::vector<std::string> tags;
+    parser.AddIntArgument("Param1").MultiValue(1).Positional().StoreValues(values);
+    parser.AddStringArgument('t', "tag").MultiValue().StoreValues(tags);
+    parser.AddFlag('f', "flag");
+    parser.PreScan();
+
+    std::vector<std::string> args = {"app", "-ftfirst"};
+    for (int i = 0; i < 10000; ++i) {
+        args.push_back(std::to_string(i));
+        if (i % 1000 == 0) {
+            args.push_back("--tag=tag" + std::to_string(i));
+        }
+    }
+    ASSERT_TRUE(parser.Parse(args));
+    ASSERT_TRUE(parser.GetFlag('f'));
+    ASSERT_EQ(values.size(), 10000);
+    ASSERT_EQ(values.capacity(), 10000);
+    ASSERT_EQ(values.back(), 9999);
+    ASSERT_EQ(tags.size(), 11);
+    ASSERT_EQ(tags.capacity(), 11);
+    ASSERT_EQ(tags[1], "tag0");
+}
+
+TEST(ArgParserTestSuite, ResponseFileTest) {
+    TempFile inner_file("inner.rsp");
+    TempFile outer_file("outer.rsp");
+    TempFile broken_file("broken.rsp");
+    TempFile loop_file("loop.rsp");
+    TempFile nested_file("nested.rsp");
+    std::string inner = inner_file.Path();
+    std::string outer = outer_file.Path();
+    std::string broken = broken_file.Path();
+    std::string loop = loop_file.Path();
+    {
+        std::ofstream file(inner);
+        for (int i = 0; i < 100000; ++i) {
+            file << i << (i % 10 == 9 ? '\n' : ' ');
+        }
+    }
+    std::ofstream(outer) << "--str 'two words'\n-f --str=\"say \\\"hi\\\"\" @" << inner << " 100000\n";
+    std::ofstream(broken) << "--str \"unterminated\n";
+    std::ofstream(loop) << "@" << loop;
+    // relative to nested.rsp, not to the working directory
+    std::ofstream(nested_file.Path()) << "--str x -f @" << std::filesystem::path(inner).filename().string();
+
+    std::vector<int> values;
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("str").MultiValue();
+    parser.AddFlag('f', "flag");
+    parser.AddIntArgument("Param1").MultiValue().Positional().StoreValues(values);
+    parser.ResponseFiles();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app @" + outer)));
+    ASSERT_EQ(parser.GetStringValue("str", 0), "two words");
+    ASSERT_EQ(parser.GetStringValue("str", 1), "say \"hi\"");
+    ASSERT_TRUE(parser.GetFlag('f'));
+    ASSERT_EQ(values.size(), 100001);
+    ASSERT_EQ(values[12345], 12345);
+    ASSERT_EQ(values.back(), 100000);
+
+    values.clear();
+    ASSERT_TRUE(parser.Parse(SplitString("app @" + nested_file.Path())));
+    ASSERT_TRUE(parser.GetFlag('f'));
+    ASSERT_EQ(values.size(), 100000);
+
+    ASSERT_FALSE(parser.Parse(SplitString("app @" + broken)));
+    ASSERT_FALSE(parser.Parse(SplitString("app @" + loop)));
+    ASSERT_FALSE(parser.Parse(SplitString("app @" + TempFile("missing.rsp").Path())));
+}
+
+TEST(ArgParserTestSuite, LayeredSourcesTest) {
+    TempFile config_file("layered.conf");
+    std::string config = config_file.Path();
+    std::ofstream(config) << "# defaults\n"
+                          << "host = \"config.example\"\n"
+                          << "port = 8080\n"
+                          << "verbose = yes\n"
+                          << "tag = first\n"
+                          << "tag = second\n"
+                          << "not a key value line\n";
+    EnvGuard port("ARGPARSER_TEST_PORT", "9090");
+    EnvGuard ids("ARGPARSER_TEST_IDS", " 1 2  3 ");
+    EnvGuard host("ARGPARSER_TEST_HOST", nullptr);
+
+    ArgParser parser("My Parser");
+    parser.AddStringArgument("host").Env("ARGPARSER_TEST_HOST");
+    parser.AddIntArgument("port").Env("ARGPARSER_TEST_PORT");
+    parser.AddIntArgument("ids").MultiValue().Env("ARGPARSER_TEST_IDS");
+    parser.AddStringArgument("tag").MultiValue();
+    parser.AddFlag('v', "verbose");
+    parser.AddIntArgument("retries").Default(3);
+    parser.ConfigFile(config);
+
+    // environment before config file, command line before both
+    ASSERT_TRUE(parser.Parse(SplitString("app --port=1")));
+    ASSERT_EQ(parser.GetIntValue("port"), 1);
+    ASSERT_EQ(parser.GetStringValue("host"), "config.example");
+    ASSERT_EQ(parser.GetStringValue("tag", 1), "second");
+    ASSERT_TRUE(parser.GetFlag('v'));
+    ASSERT_EQ(parser.GetIntValue("retries"), 3);
+    ASSERT_EQ(parser.GetIntValues("ids").size(), 3);
+    ASSERT_EQ(parser.GetIntValue("ids", 2), 3);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --host=cli")));
+    ASSERT_EQ(parser.GetStringValue("host"), "cli");
+    ASSERT_EQ(parser.GetIntValue("port"), 9090);
+
+    port.Set("not a number");
+    ASSERT_FALSE(parser.Parse(SplitString("app")));
+    ASSERT_TRUE(parser.Parse(SplitString("app --port 2")));
+}
+
+TEST(ArgParserTestSuite, SubcommandTest) {
+    int factory_calls = 0;
+    ArgParser parser("tool");
+    parser.AddFlag('v', "verbose");
+    parser.AddStringArgument("file").MultiValue().Positional();
+    parser.AddHelp('h', "help", "Multi-tool");
+    for (int i = 0; i < 300; ++i) {
+        parser.AddSubcommand("cmd" + std::to_string(i), [&factory_calls](Schema& schema) {
+            ++factory_calls;
+            schema.AddIntArgument('j', "jobs").Default(1);
+        });
+    }
+    parser.AddSubcommand("build", [&factory_calls](Schema& schema) {
+        ++factory_calls;
+        schema.AddIntArgument('j', "jobs");
+        schema.AddStringArgument("target").MultiValue().Positional();
+        schema.AddHelp('h', "help", "Builds targets");
+    }, "Build the given targets");
+
+    ASSERT_TRUE(parser.Parse(SplitString("tool -v a.txt build --jobs 8 all docs")));
+    ASSERT_EQ(factory_calls, 1);
+    ASSERT_FALSE(parser.GetSchema().IsSubcommandBuilt(0));
+    ASSERT_TRUE(parser.GetFlag('v'));
+    ASSERT_EQ(parser.GetStringValue("file"), "a.txt");
+    ASSERT_EQ(parser.GetSubcommand(), "build");
+    const ParseResult* build = parser.GetSubcommandResult();
+    ASSERT_NE(build, nullptr);
+    ASSERT_EQ(build->GetIntValue("jobs"), 8);
+    ASSERT_EQ(build->GetStringValue("target", 1), "docs");
+
+    // a subcommand name that is an option value stays a value
+    ASSERT_TRUE(parser.Parse(SplitString("tool --file build")));
+    ASSERT_EQ(parser.GetSubcommand(), "");
+    ASSERT_EQ(parser.GetSubcommandResult(), nullptr);
+
+    ASSERT_FALSE(parser.Parse(SplitString("tool build all")));
+    ASSERT_TRUE(parser.Parse(SplitString("tool build --help")));
+    ASSERT_TRUE(parser.Help());
+    ASSERT_EQ(factory_calls, 1);
+    std::string help = parser.HelpDescription();
+    size_t line = help.find("\n  build ");
+    ASSERT_NE(line, std::string::npos);
+    ASSERT_EQ(help.find("Build the given targets"), help.find_first_not_of(' ', line + 8));
+}
+
+TEST(ArgParserTestSuite, RealArgumentTest) {
+    std::vector<float> weights;
+    double threshold = 0;
+    ArgParser parser("My Parser");
+    parser.AddDoubleArgument('t', "threshold").StoreValue(threshold);
+    parser.AddDoubleArgument("scale").Default(1.5);
+    parser.AddFloatArgument('w', "weights").MultiValue(2).Positional().StoreValues(weights);
+    parser.AddDoubleArgument("bias").MultiValue();
+    parser.AddDoubleArgument("offset").Default(5);
+    parser.AddFloatArgument("gain").Default(2);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -t 0.1 0.25 1e-3 --bias=-2.5 --bias=+7 3.4028234e38")));
+    ASSERT_EQ(parser.GetDoubleValue("offset"), 5.0);
+    ASSERT_EQ(parser.GetDoubleValue("gain"), 2.0);
+    ASSERT_EQ(threshold, 0.1);
+    ASSERT_EQ(parser.GetDoubleValue("threshold"), 0.1);
+    ASSERT_EQ(parser.GetDoubleValue("scale"), 1.5);
+    ASSERT_EQ(weights.size(), 3);
+    ASSERT_EQ(weights[1], 1e-3f);
+    ASSERT_EQ(parser.GetFloatValues("weights").size(), 3);
+    ASSERT_EQ(parser.GetDoubleValues("bias").size(), 2);
+    ASSERT_EQ(parser.GetDoubleValue("bias", 0), -2.5);
+    ASSERT_EQ(parser.GetDoubleValue("bias", 1), 7.0);
+
+    ASSERT_FALSE(parser.Parse(SplitString("app -t 0,5 1 2")));
+    ASSERT_FALSE(parser.Parse(SplitString("app -t 1e999 1 2")));
+    ASSERT_FALSE(parser.Parse(SplitString("app -t 1 1 1e39")));
+    ASSERT_FALSE(parser.Parse(SplitString("app --threshold nan 1 2")));
+    ASSERT_FALSE(parser.Parse(SplitString("app -t 1 1 inf")));
+    ASSERT_NE(parser.HelpDescription().find("--weights=<float>"), std::string::npos);
+
+    ArgParser limits("Limits");
+    limits.AddDoubleArgument("upper").NonFinite();
+    limits.AddArgument<float>("lower").MultiValue().NonFinite();
+    ASSERT_TRUE(limits.Parse(SplitString("app --upper=inf --lower=-infinity --lower nan 1")));
+    ASSERT_TRUE(std::isinf(limits.GetDoubleValue("upper")));
+    ASSERT_TRUE(std::isnan(limits.GetFloatValues("lower")[1]));
+    limits.ParallelConversion(2, 1);
+    ASSERT_TRUE(limits.Parse(SplitString("app --upper=1 --lower inf nan")));
+    ASSERT_TRUE(std::isnan(limits.GetFloatValues("lower")[1]));
+}
+
+TEST(ArgParserTestSuite, ParallelConversionTest) {
+    std::vector<std::string> args = {"app", "--weights"};
+    for (int i = 0; i < 50000; ++i) {
+        args.push_back(std::to_string(i) + ".5");
+    }
+    args.push_back("-v");
+    for (int i = 0; i < 200000; ++i) {
+        args.push_back(std::to_string(i * 7 + 1));
+    }
+
+    std::vector<int> values;
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("Param1").MultiValue().Positional().StoreValues(values);
+    parser.AddDoubleArgument("weights").MultiValue();
+    parser.AddFlag('v', "verbose");
+    parser.ParallelConversion(4, 1000).PreScan();
+
+    ASSERT_TRUE(parser.Parse(args));
+    ASSERT_TRUE(parser.GetFlag('v'));
+    ASSERT_EQ(parser.GetDoubleValues("weights").size(), 50000);
+    ASSERT_EQ(parser.GetDoubleValue("weights", 49999), 49999.5);
+    ASSERT_EQ(values.size(), 200000);
+    for (int i = 0; i < 200000; ++i) {
+        ASSERT_EQ(values[i], i * 7 + 1);
+    }
+
+    // a bad token fails the parse and keeps exactly the values a sequential
+    // parse keeps
+    args[args.size() - 100000] = "12x";
+    values.clear();
+    ASSERT_FALSE(parser.Parse(args));
+    ASSERT_EQ(values.size(), 199999);
+    ASSERT_EQ(values[99999], 99999 * 7 + 1);
+    ASSERT_EQ(values[100000], 100001 * 7 + 1);
+}
+
+namespace {
+    struct Bytes {
+        uint64_t count = 0;
+    };
+} // namespace
+
+template <>
+struct ArgumentParser::ValueConverter<Bytes> {
+    static constexpr std::string_view kTypeName = "bytes";
+
+    static bool Convert(std::string_view token, Bytes& value) {
+        uint64_t scale = 1;
+        if (!token.empty() && (token.back() == 'k' || token.back() == 'M')) {
+            scale = token.back() == 'k' ? 1024 : 1024 * 1024;
+            token.remove_suffix(1);
+        }
+        if (!ConvertInteger(token, value.count)) {
+            return false;
+        }
+        value.count *= scale;
+        return true;
+    }
+};
+
+TEST(ArgParserTestSuite, TypedArgumentTest) {
+    std::vector<Bytes> limits;
+    uint32_t port = 0;
+    ArgParser parser("My Parser");
+    parser.AddArgument<int64_t>("offset").Default(int64_t{-1});
+    parser.AddArgument<uint32_t>('p', "port").StoreValue(port);
+    parser.AddArgument<Bytes>("limit", "Memory limits").MultiValue(1).StoreValues(limits);
+    parser.AddArgument<Bytes>("buffer").Default(Bytes{4096});
+    parser.AddArgument<int>('n', "number").Default(0);
+    parser.AddArgument<std::string>("name").Default("none");
+    parser.AddArgument<bool>('v', "verbose");
+    parser.AddArgument<int64_t>("big").Default(7);
+    parser.AddArgument<float>("ratio").Default(2);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app --offset=12345678901 -p 8080 --limit 4k 16M 7 -n 3 -v")));
+    ASSERT_EQ(parser.GetValue<int64_t>("offset"), 12345678901);
+    ASSERT_EQ(port, 8080);
+    ASSERT_EQ(parser.GetValue<uint32_t>("port"), 8080);
+    ASSERT_EQ(limits.size(), 3);
+    ASSERT_EQ(limits[1].count, 16 * 1024 * 1024);
+    ASSERT_EQ(parser.GetValues<Bytes>("limit").size(), 3);
+    ASSERT_EQ(parser.GetValue<Bytes>("buffer").count, 4096);
+    ASSERT_EQ(parser.GetValue<int>("number"), 3);
+    ASSERT_EQ(parser.GetValue<std::string>("name"), "none");
+    ASSERT_TRUE(parser.GetValue<bool>("verbose"));
+    ASSERT_EQ(parser.GetValue<int64_t>("big"), 7);
+    ASSERT_EQ(parser.GetValue<float>("ratio"), 2.0f);
+
+    limits.clear();
+    ASSERT_TRUE(parser.Parse(SplitString("app -p 1 --limit 1")));
+    ASSERT_EQ(parser.GetValue<int64_t>("offset"), -1);
+    ASSERT_FALSE(parser.Parse(SplitString("app -p 4294967296 --limit 1")));
+    ASSERT_FALSE(parser.Parse(SplitString("app -p 1 --limit 4G")));
+    ASSERT_NE(parser.HelpDescription().find("--limit=<bytes>,"), std::string::npos);
+
+    ArgParser wide("Wide");
+    wide.AddArgument<int64_t>("ids").MultiValue(1).Positional();
+    wide.AddArgument<uint32_t>("ports").MultiValue();
+    ASSERT_EQ(wide.GetSchema().GetDefinition(0).GetType(), ArgumentSettings::Type::Int64);
+    ASSERT_TRUE(wide.Parse(SplitString("app 12345678901 5 7 --ports 80 443")));
+    ASSERT_EQ(wide.GetValues<int64_t>("ids").size(), 3);
+    ASSERT_EQ(wide.GetValues<int64_t>("ids")[0], 12345678901);
+    ASSERT_EQ(wide.GetValues<int64_t>("ids")[2], 7);
+    ASSERT_EQ(wide.GetValues<uint32_t>("ports")[1], 443);
+    ASSERT_FALSE(wide.Parse(SplitString("app 1 2x 3")));
+}
+
+TEST(ArgParserTestSuite, BatchTypedColumnsTest) {
+    ArgParser parser("My Parser");
+    parser.AddArgument<int64_t>("offset").Default(int64_t{-1});
+    parser.AddArgument<uint64_t>("size").MultiValue();
+    parser.AddArgument<uint32_t>("port").Default(80u);
+    std::vector<std::vector<std::string>> lines = {SplitString("app --offset=12345678901 --size 1 18446744073709551615"),
+                                                   SplitString("app --port 8080 --size 5"),
+                                                   SplitString("app --port 4294967296")};
+    BatchResult result = BatchParser(parser, 2).Parse(lines);
+    ASSERT_EQ(result.GetInt64Value("offset", 0), 12345678901);
+    ASSERT_EQ(result.GetUInt64Values("size", 0).size(), 2);
+    ASSERT_EQ(result.GetUInt64Value("size", 0, 1), 18446744073709551615u);
+    ASSERT_EQ(result.GetInt64Value("port", 0), 80);
+    ASSERT_EQ(result.GetInt64Value("offset", 1), -1);
+    ASSERT_EQ(result.GetValueCount("size", 1), 1);
+    ASSERT_EQ(result.GetInt64Value("port", 1), 8080);
+    ASSERT_FALSE(result.IsParsed(2));
+
+    ArgParser custom("Custom");
+    custom.AddArgument<Bytes>("limit");
+    ASSERT_THROW(BatchParser batch_custom(custom), std::invalid_argument);
+}
+
+TEST(ArgParserTestSuite, ParseErrorTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument('n', "number");
+    parser.AddIntArgument("values").MultiValue(2).Default(0);
+    parser.AddFlag('v', "verbose");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --number=12x -vq --size --values 1 2")));
+    ASSERT_EQ(parser.ErrorCount(), 3);
+    ParseError bad_value = parser.GetErrors()[0];
+    ASSERT_EQ(bad_value.code, ParseErrorCode::InvalidValue);
+    ASSERT_EQ(bad_value.token, 1);
+    ASSERT_EQ(bad_value.offset, 9);
+    ASSERT_EQ(bad_value.length, 3);
+    ASSERT_EQ(parser.GetSchema().GetName(bad_value.argument), "number");
+    ParseError unknown_short = parser.GetErrors()[1];
+    ASSERT_EQ(unknown_short.code, ParseErrorCode::UnknownOption);
+    ASSERT_EQ(unknown_short.token, 2);
+    ASSERT_EQ(unknown_short.offset, 2);
+    ASSERT_EQ(unknown_short.length, 1);
+    ParseError unknown_long = parser.GetErrors()[2];
+    ASSERT_EQ(unknown_long.code, ParseErrorCode::UnknownOption);
+    ASSERT_EQ(unknown_long.token, 3);
+    ASSERT_EQ(unknown_long.offset, 2);
+    ASSERT_EQ(unknown_long.length, 4);
+    ASSERT_EQ(unknown_long.argument, ParseError::kNone);
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --values 1 -v stray -n")));
+    ASSERT_EQ(parser.ErrorCount(), 3);
+    ASSERT_EQ(parser.GetErrors()[0].code, ParseErrorCode::UnexpectedPositional);
+    ASSERT_EQ(parser.GetErrors()[0].token, 4);
+    ASSERT_EQ(parser.GetErrors()[1].code, ParseErrorCode::MissingValue);
+    ASSERT_EQ(parser.GetErrors()[1].token, 5);
+    ASSERT_EQ(parser.GetErrors()[1].offset, 1);
+    ASSERT_EQ(parser.GetErrors()[2].code, ParseErrorCode::TooFewValues);
+    ASSERT_EQ(parser.GetErrors()[2].token, ParseError::kNone);
+    ASSERT_EQ(parser.GetSchema().GetName(parser.GetErrors()[2].argument), "values");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app --values 1 2")));
+    ASSERT_EQ(parser.ErrorCount(), 1);
+    ASSERT_EQ(parser.GetErrors()[0].code, ParseErrorCode::MissingArgument);
+    ASSERT_EQ(ToString(parser.GetErrors()[0].code), "missing required argument");
+
+    ASSERT_FALSE(parser.Parse(SplitString("app -n 1 --values 1 2 -x -x -x -x -x -x -x -x -x -x")));
+    ASSERT_EQ(parser.ErrorCount(), 10);
+    ASSERT_EQ(parser.GetErrors().size(), ParseResult::kMaxErrors);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 1 -v --values 1 2")));
+    ASSERT_EQ(parser.ErrorCount(), 0);
+    ASSERT_TRUE(parser.GetErrors().empty());
+}
+
+TEST(ArgParserTestSuite, OptionHandleTest) {
+    ArgParser parser("My Parser");
+    Option<int> number = parser.AddIntArgument('n', "number").Default(1).Handle<int>();
+    Option<std::string> name = parser.AddStringArgument("name").Default("none").Handle<std::string>();
+    Option<bool> verbose = parser.AddFlag('v', "verbose").Handle<bool>();
+    Option<double> weights = parser.AddDoubleArgument("weights").MultiValue().Positional().Handle<double>();
+    Option<int64_t> offset = parser.AddArgument<int64_t>("offset").Default(int64_t{-1}).Handle<int64_t>();
+    ASSERT_FALSE(parser.Handle<int>().IsValid());
+
+    ASSERT_TRUE(parser.Parse(SplitString("app -n 5 --name=first -v 0.5 1.5 --offset 7")));
+    const int& number_value = parser.Get(number);
+    ASSERT_EQ(number_value, 5);
+    ASSERT_EQ(&number_value, &parser.Get(number));
+    ASSERT_EQ(parser.Get(name), "first");
+    ASSERT_TRUE(parser.Get(verbose));
+    ASSERT_EQ(parser.Get(weights, 1), 1.5);
+    ASSERT_EQ(parser.GetValues(weights).size(), 2);
+    ASSERT_EQ(parser.Get(offset), 7);
+
+    ASSERT_TRUE(parser.Parse(SplitString("app 2.5")));
+    ASSERT_EQ(parser.Get(number), 1);
+    ASSERT_EQ(parser.Get(name), "none");
+    ASSERT_FALSE(parser.Get(verbose));
+    ASSERT_EQ(parser.Get(offset), -1);
+    ASSERT_EQ(parser.GetValues(weights).size(), 1);
+
+    ASSERT_EQ(parser.Get(Option<int>()), 0);
+    ASSERT_EQ(parser.Get(Option<int>(name.Index())), 0);
+}
+
+TEST(ArgParserTestSuite, AbbreviationTest) {
+    for (bool is_frozen : {false, true}) {
+        ArgParser parser("My Parser");
+        parser.AddFlag("verbose").Default(false);
+        parser.AddFlag("version").Default(false);
+        parser.AddIntArgument("output-width").Default(80);
+        parser.AddIntArgument("output-height").Default(24);
+        parser.AddStringArgument("out").Default("");
+        parser.Abbreviations();
+        if (is_frozen) {
+            parser.Freeze();
+        }
+
+        ASSERT_TRUE(parser.Parse(SplitString("app --verb --output-w=100 --output-h 50 --out file")));
+        ASSERT_TRUE(parser.GetFlag("verbose"));
+        ASSERT_FALSE(parser.GetFlag("version"));
+        ASSERT_EQ(parser.GetIntValue("output-width"), 100);
+        ASSERT_EQ(parser.GetIntValue("output-height"), 50);
+        ASSERT_EQ(parser.GetStringValue("out"), "file");
+
+        ASSERT_FALSE(parser.Parse(SplitString("app --ver")));
+        ASSERT_EQ(parser.GetErrors()[0].code, ParseErrorCode::AmbiguousOption);
+        std::vector<size_t> candidates = parser.GetSchema().FindCandidates("ver");
+        ASSERT_EQ(candidates.size(), 2);
+        ASSERT_EQ(parser.GetSchema().GetName(candidates[0]), "verbose");
+        ASSERT_EQ(parser.GetSchema().GetName(candidates[1]), "version");
+
+        ASSERT_FALSE(parser.Parse(SplitString("app --output-depth 3")));
+        ASSERT_EQ(parser.GetErrors()[0].code, ParseErrorCode::UnknownOption);
+        ASSERT_EQ(parser.GetSchema().FindCandidates("output-depth").size(), 2);
+        ASSERT_TRUE(parser.GetSchema().FindCandidates("width").empty());
+
+        parser.Abbreviations(false);
+        ASSERT_FALSE(parser.Parse(SplitString("app --verb")));
+        ASSERT_EQ(parser.GetErrors()[0].code, ParseErrorCode::UnknownOption);
+    }
+}
+
+TEST(ArgParserTestSuite, StreamParserTest) {
+    Schema schema("tool");
+    schema.AddFlag('v', "verbose").Default(false);
+    schema.AddIntArgument('n', "number").Default(0);
+    schema.AddIntArgument("values").MultiValue().Default(0);
+    schema.AddStringArgument("file").MultiValue().Positional();
+    schema.AddSubcommand("build", [](Schema& build) {
+        build.AddIntArgument('j', "jobs");
+    });
+
+    std::vector<std::string> completed;
+    ParseResult result;
+    {
+        StreamParser stream(schema, result, [&](const ParseResult& part, size_t index) {
+            completed.push_back((&part == &result ? "" : "build:") + std::to_string(index));
+        });
+        for (std::string token : {"-v", "--values", "1"}) {
+            stream.Feed(token);
+        }
+        ASSERT_FALSE(stream.IsAwaitingValue());
+        ASSERT_EQ(completed, std::vector<std::string>({"0"}));
+        stream.Feed("2");
+        stream.Feed("-n");
+        ASSERT_TRUE(stream.IsAwaitingValue());
+        ASSERT_EQ(completed, std::vector<std::string>({"0", "2"}));
+        {
+            // the engine keeps its own copy of every value
+            std::string token = "5";
+            stream.Feed(token);
+            token = "x";
+        }
+        stream.Feed("a.txt");
+        stream.Feed("b.txt");
+        ASSERT_EQ(completed, std::vector<std::string>({"0", "2", "1"}));
+        stream.Feed("build");
+        stream.Feed("-j");
+        stream.Feed("8");
+        ASSERT_TRUE(stream.Finish());
+        ASSERT_EQ(completed, std::vector<std::string>({"0", "2", "1", "3", "build:0"}));
+    }
+    ASSERT_TRUE(result.GetFlag('v'));
+    ASSERT_EQ(result.GetIntValue("number"), 5);
+    ASSERT_EQ(result.GetIntValues("values").size(), 2);
+    ASSERT_EQ(result.GetStringValue("file", 1), "b.txt");
+    ASSERT_EQ(result.GetSubcommand(), "build");
+    ASSERT_EQ(result.GetSubcommandResult()->GetIntValue("jobs"), 8);
+
+    StreamParser failing(schema, result);
+    failing.Feed("--values");
+    failing.Feed("--number=x");
+    ASSERT_FALSE(failing.Finish());
+    ASSERT_EQ(result.ErrorCount(), 3);
+    ASSERT_EQ(result.GetErrors()[0].code, ParseErrorCode::MissingValue);
+    ASSERT_EQ(result.GetErrors()[0].token, 1);
+    ASSERT_EQ(result.GetErrors()[1].code, ParseErrorCode::InvalidValue);
+    ASSERT_EQ(result.GetErrors()[1].token, 2);
+    ASSERT_EQ(result.GetErrors()[1].offset, 9);
+    ASSERT_EQ(result.GetErrors()[2].code, ParseErrorCode::MissingArgument);
+}
+
+TEST(ArgParserTestSuite, ValueRangeTest) {
+    ArgParser parser("My Parser");
+    parser.AddIntArgument("Param1").MultiValue().Positional();
+    parser.AddStringArgument('s', "str").MultiValue();
+    parser.AddIntArgument("lazy").MultiValue().Lazy();
+
+    ASSERT_TRUE(parser.Parse(SplitString("app 1 2 3 -s a --str=b --lazy=7 --lazy=x8 --lazy=-9")));
+    std::span<const int> values = parser.GetIntValues("Param1");
+    ASSERT_EQ(std::vector<int>(values.begin(), values.end()), std::vector<int>({1, 2, 3}));
+
+    std::vector<std::string_view> strings;
+    for (std::string_view value : parser.GetStringValues("str")) {
+        strings.push_back(value);
+    }
+    ASSERT_EQ(strings, std::vector<std::string_view>({"a", "b"}));
+    ASSERT_EQ(parser.GetStringValues("str")[1], "b");
+
+    auto lazy = parser.GetLazyIntValues("lazy");
+    ASSERT_EQ(lazy.size(), 3);
+    ASSERT_EQ(lazy[0], 7);
+    ASSERT_FALSE(lazy[1].has_value());
+    ASSERT_EQ(lazy[2], -9);
+    ASSERT_EQ(parser.GetIntValue("lazy", 2), -9);
+    ASSERT_TRUE(parser.GetIntValues("lazy").empty());
+    ASSERT_TRUE(parser.GetStringValues("missing").empty());
+}
+
+TEST(ArgParserTestSuite, AllocationScopeTest) {
+    ASSERT_TRUE(AllocationScope::IsEnabled());
+    AllocationScope outer;
+    auto first = std::make_unique<std::array<char, 1000>>();
+    {
+        AllocationScope inner;
+        auto second = std::make_unique<std::array<char, 500>>();
+        second.reset();
+        auto third = std::make_unique<std::array<char, 200>>();
+        AllocationStats stats = inner.Stats();
+        ASSERT_EQ(stats.allocations, 2);
+        ASSERT_EQ(stats.bytes, 700);
+        ASSERT_EQ(stats.peak_bytes, 500);
+    }
+    AllocationStats stats = outer.Stats();
+    ASSERT_EQ(stats.allocations, 3);
+    ASSERT_EQ(stats.peak_bytes, 1500);
+}
+
+TEST(ArgParserTestSuite, ZeroAllocationParseTest) {
+    Schema schema("My Parser");
+    schema.AddStringArgument("param1").Default("");
+    schema.AddIntArgument('n', "number").Default(0);
+    schema.AddFlag('a', "all");
+    schema.AddFlag('b', "brief");
+    schema.AddStringArgument('t', "tag").MultiValue().Default("");
+    schema.AddIntArgument("Param1").MultiValue().Positional().Default(0);
+
+    std::vector<std::vector<std::string>> lines = {
+        {"app", "--param1=value1"},
+        {"app", "--param1", "a value longer than the small string buffer"},
+        {"app", "-ab", "-n", "5", "--number=-7"},
+        {"app", "-abn5", "-t", "first", "--tag=second", "-tthird"},
+        {"app", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12"},
+    };
+    for (bool frozen : {false, true}) {
+        if (frozen) {
+            schema.Freeze();
+        }
+        ParseResult result(schema);
+        for (const std::vector<std::string>& line : lines) {
+            // warm up the result's arena and value vectors
+            for (int i = 0; i < 3; ++i) {
+                ASSERT_TRUE(schema.Parse(line, result)) << line[1];
+            }
+            AllocationScope scope;
+            ASSERT_TRUE(schema.Parse(line, result));
+            ASSERT_EQ(scope.Stats().allocations, 0) << line[1];
+        }
+    }
+}
+
+TEST(ArgParserTestSuite, ColdParseAllocationBudgetTest) {
+    Schema schema("My Parser");
+    schema.AddStringArgument("param1");
+    schema.AddIntArgument('n', "number").Default(0);
+    schema.AddFlag('f', "flag");
+
+    std::vector<std::string> args = {"app", "--param1=value1", "-f"};
+    AllocationScope scope;
+    ParseResult result = schema.Parse(args);
+    ASSERT_TRUE(result);
+    // the result's value vector, plus the arena with its block list and first block
+    ASSERT_LE(scope.Stats().allocations, 4);
+    ASSERT_LE(scope.Stats().peak_bytes, 8192);
+}
+
+TEST(ArgParserTestSuite, HelpLayoutTest) {
+    Schema schema("My Parser");
+    schema.AddHelp('h', "help", "Some Description about program");
+    schema.AddStringArgument('i', "input", "File path for input file").MultiValue(1);
+    schema.AddFlag('s', "flag1", "Use some logic");
+    schema.AddIntArgument("numer", "Some Number that is described with quite a few words");
+    schema.HelpWidth(60);
+
+    const std::string expected =
+        "My Parser\n"
+        "Some Description about program\n"
+        "\n"
+        "-i,  --input=<string>,  File path for input file [repeated,\n"
+        "                        min args = 1]\n"
+        "-s,  --flag1,           Use some logic\n"
+        "     --numer=<int>,     Some Number that is described with\n"
+        "                        quite a few words\n"
+        "\n"
+        "-h, --help Display this help and exit\n";
+    ASSERT_EQ(schema.HelpDescription(), expected);
+
+    schema.Freeze();
+    std::ostringstream out;
+    schema.WriteHelp(out);
+    ASSERT_EQ(out.str(), expected);
+
+    std::array<char, 16> small;
+    ASSERT_EQ(schema.WriteHelp(small), expected.size());
+    ASSERT_EQ(std::string_view(small.data(), small.size()), expected.substr(0, small.size()));
+
+    schema.AddFlag("late", "Added after Freeze");
+    ASSERT_NE(schema.HelpDescription().find("--late,"), std::string::npos);
+}